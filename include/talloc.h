@@ -0,0 +1,270 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Выделение памяти с выравниванием на строку кэша и на больших страницах
+
+#ifndef __TALLOC_H__
+#define __TALLOC_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <limits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Выравнивание памяти векторов и строк матриц в байтах: строка кэша
+// и ширина регистра AVX-512. Степень двойки, не меньше 2 * sizeof(void*)
+#ifndef TMATRIX_ALIGNMENT
+#define TMATRIX_ALIGNMENT 64
+#endif
+
+// Большие страницы.
+// Блоки не меньше порога отображаются mmap отдельно от кучи: в режиме
+// HUGE_PAGES_TRANSPARENT область выравнивается на большую страницу и
+// помечается MADV_HUGEPAGE, в режиме HUGE_PAGES_EXPLICIT сначала
+// запрашиваются страницы hugetlbfs (MAP_HUGETLB). Если система не даёт
+// больших страниц, блок берётся из кучи. Только для Linux
+#ifndef TMATRIX_HUGE_PAGE_SIZE
+#define TMATRIX_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#endif
+#ifndef TMATRIX_HUGE_PAGE_THRESHOLD
+#define TMATRIX_HUGE_PAGE_THRESHOLD (4 * 1024 * 1024)
+#endif
+
+enum THugePageMode
+{
+  HUGE_PAGES_OFF,          // все блоки из кучи
+  HUGE_PAGES_TRANSPARENT,  // mmap + MADV_HUGEPAGE
+  HUGE_PAGES_EXPLICIT      // hugetlbfs, иначе как HUGE_PAGES_TRANSPARENT
+};
+
+// Статистика больших страниц: блоки, живущие сейчас
+struct THugePageStats
+{
+  size_t blocks;         // число отображённых блоков
+  size_t bytes;          // байт в отображённых блоках
+  size_t hugetlb_bytes;  // из них байт на страницах hugetlbfs
+};
+
+// Режим больших страниц процесса и счётчики отображённых блоков
+class THugePages
+{
+  struct TState
+  {
+    std::atomic<int> mode;
+    std::atomic<size_t> threshold;
+    std::atomic<size_t> blocks, bytes, hugetlb;
+
+    TState() : mode(HUGE_PAGES_OFF), threshold(TMATRIX_HUGE_PAGE_THRESHOLD), blocks(0), bytes(0), hugetlb(0) {}
+  };
+  static TState& state() noexcept
+  {
+    static TState s;
+    return s;
+  }
+
+  // len байт, выровненных на большую страницу; nullptr, если не удалось
+  static char* map(size_t len, bool& tlb) noexcept
+  {
+#if defined(__linux__)
+#ifdef MAP_HUGETLB
+    if (state().mode == HUGE_PAGES_EXPLICIT)
+    {
+      void* m = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (m != MAP_FAILED)
+      {
+        tlb = true;
+        return static_cast<char*>(m);
+      }
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    // лишнее до и после выровненной области возвращается системе
+    const size_t huge = TMATRIX_HUGE_PAGE_SIZE;
+    void* m = mmap(nullptr, len + huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED)
+      return nullptr;
+    char* raw = static_cast<char*>(m);
+    char* base = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + huge - 1) & ~uintptr_t(huge - 1));
+    if (base != raw)
+      munmap(raw, base - raw);
+    if (base + len != raw + len + huge)
+      munmap(base + len, raw + huge - base);
+    if (madvise(base, len, MADV_HUGEPAGE) != 0)
+    {
+      munmap(base, len);
+      return nullptr;
+    }
+    tlb = false;
+    return base;
+#endif
+#endif
+    (void)len;
+    (void)tlb;
+    return nullptr;
+  }
+public:
+  THugePages() = delete;
+
+  // режим и порог в байтах для блоков, выделяемых после вызова
+  static void set_mode(THugePageMode m, size_t threshold_bytes = TMATRIX_HUGE_PAGE_THRESHOLD) noexcept
+  {
+    state().threshold = threshold_bytes;
+    state().mode = m;
+  }
+  static THugePageMode mode() noexcept { return THugePageMode(state().mode.load()); }
+  static size_t threshold() noexcept { return state().threshold; }
+
+  static THugePageStats stats() noexcept
+  {
+    const TState& s = state();
+    return THugePageStats{ s.blocks.load(), s.bytes.load(), s.hugetlb.load() };
+  }
+  // байт процесса, которые ядро сейчас держит на прозрачных больших
+  // страницах (AnonHugePages из /proc/self/smaps_rollup), 0 вне Linux
+  static size_t anon_huge_bytes()
+  {
+#if defined(__linux__)
+    std::ifstream f("/proc/self/smaps_rollup");
+    std::string key;
+    size_t kb;
+    while (f >> key)
+    {
+      if (key == "AnonHugePages:" && f >> kb)
+        return kb * 1024;
+      f.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+#endif
+    return 0;
+  }
+
+  // отображение блока bytes байт, данные с выравниванием align начинаются
+  // через align байт от начала области; nullptr - блок нужно взять из кучи
+  static void* allocate(size_t bytes, size_t align, size_t& len, bool& tlb) noexcept
+  {
+    if (mode() == HUGE_PAGES_OFF || bytes < threshold())
+      return nullptr;
+    const size_t huge = TMATRIX_HUGE_PAGE_SIZE;
+    len = (bytes + align + huge - 1) / huge * huge;
+    char* base = map(len, tlb);
+    if (base == nullptr)
+      return nullptr;
+    TState& s = state();
+    s.blocks++;
+    s.bytes += len;
+    if (tlb)
+      s.hugetlb += len;
+    return base + align;
+  }
+  static void release(void* base, size_t len, bool tlb) noexcept
+  {
+    TState& s = state();
+    s.blocks--;
+    s.bytes -= len;
+    if (tlb)
+      s.hugetlb -= len;
+#if defined(__linux__)
+    munmap(base, len);
+#else
+    (void)base;
+#endif
+  }
+};
+
+// Заголовок перед выровненным блоком: начало области и длина отображения
+// (0 - блок из кучи, младший бит - страницы hugetlbfs)
+struct TAlignedHeader
+{
+  void* raw;
+  size_t mapped;
+};
+
+// bytes байт с выравниванием align (степень двойки, не меньше
+// sizeof(TAlignedHeader)). Блок берётся у ::operator new с запасом align
+// байт или отображается на большие страницы, заголовок хранится перед
+// выровненным адресом
+inline void* aligned_allocate(size_t bytes, size_t align)
+{
+  if (bytes > size_t(-1) - align - TMATRIX_HUGE_PAGE_SIZE)
+    throw std::bad_alloc();
+  void* p;
+  size_t len = 0;
+  bool tlb = false;
+  char* raw;
+  if ((p = THugePages::allocate(bytes, align, len, tlb)) != nullptr)
+    raw = static_cast<char*>(p) - align;
+  else
+  {
+    raw = static_cast<char*>(::operator new(bytes + align));
+    // raw выровнен не хуже заголовка, поэтому сдвиг не превышает align
+    p = reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(raw) + sizeof(TAlignedHeader) + align - 1) &
+      ~uintptr_t(align - 1));
+  }
+  TAlignedHeader* h = static_cast<TAlignedHeader*>(p) - 1;
+  h->raw = raw;
+  h->mapped = len | size_t(tlb);
+  return p;
+}
+// освобождение блока, полученного aligned_allocate
+inline void aligned_deallocate(void* p) noexcept
+{
+  if (p == nullptr)
+    return;
+  const TAlignedHeader* h = static_cast<const TAlignedHeader*>(p) - 1;
+  if (h->mapped != 0)
+    THugePages::release(h->raw, h->mapped & ~size_t(1), (h->mapped & 1) != 0);
+  else
+    ::operator delete(h->raw);
+}
+
+// Распределитель с выравниванием -
+// распределитель векторов и матриц по умолчанию
+template<typename T, size_t Align = TMATRIX_ALIGNMENT>
+class TAlignedAllocator
+{
+  static_assert((Align & (Align - 1)) == 0 && Align >= sizeof(TAlignedHeader) && Align >= alignof(T),
+    "Align should be a power of two not less than sizeof(TAlignedHeader) and alignof(T)");
+public:
+  typedef T value_type;
+  typedef std::true_type is_always_equal;
+  // все экземпляры равны, поэтому перемещение забирает память без копирования
+  typedef std::true_type propagate_on_container_move_assignment;
+  template<typename U>
+  struct rebind
+  {
+    typedef TAlignedAllocator<U, Align> other;
+  };
+
+  static const size_t alignment = Align;
+
+  TAlignedAllocator() noexcept {}
+  template<typename U>
+  TAlignedAllocator(const TAlignedAllocator<U, Align>&) noexcept {}
+
+  T* allocate(size_t n)
+  {
+    if (n > size_t(-1) / sizeof(T))
+      throw std::bad_alloc();
+    return static_cast<T*>(aligned_allocate(n * sizeof(T), Align));
+  }
+  void deallocate(T* p, size_t) noexcept
+  {
+    aligned_deallocate(p);
+  }
+
+  friend bool operator==(const TAlignedAllocator&, const TAlignedAllocator&) noexcept { return true; }
+  friend bool operator!=(const TAlignedAllocator&, const TAlignedAllocator&) noexcept { return false; }
+};
+
+template<typename T, size_t Align>
+const size_t TAlignedAllocator<T, Align>::alignment;
+
+#endif
@@ -0,0 +1,179 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Арена для временных векторов и матриц.
+// Память выдаётся сдвигом указателя внутри крупных блоков и возвращается
+// вся сразу при выходе из области TArenaScope; сами блоки остаются
+// у арены и используются на следующей итерации
+
+#ifndef __TMatrixArena_H__
+#define __TMatrixArena_H__
+
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "tmatrix.h"
+
+// Монотонная арена -
+// список блоков, внутри текущего блока память выделяется сдвигом
+// указателя. Освобождение отдельных объектов не поддерживается:
+// арена откатывается к отметке целиком
+class TMatrixArena
+{
+  struct TChunk
+  {
+    char* mem;
+    size_t size;
+  };
+  std::vector<TChunk> chunks;
+  size_t chunk_size;
+  size_t cur;   // текущий блок
+  size_t used;  // занято байт в текущем блоке
+
+  static TMatrixArena*& current_ref() noexcept
+  {
+    static thread_local TMatrixArena* a = nullptr;
+    return a;
+  }
+  friend class TArenaScope;
+public:
+  // положение арены, к которому её можно откатить
+  struct TMarker
+  {
+    size_t chunk;
+    size_t offset;
+  };
+
+  explicit TMatrixArena(size_t block_size = 1 << 20) : chunk_size(block_size), cur(0), used(0) {}
+  TMatrixArena(const TMatrixArena&) = delete;
+  TMatrixArena& operator=(const TMatrixArena&) = delete;
+  ~TMatrixArena()
+  {
+    for (size_t i = 0; i < chunks.size(); i++)
+      ::operator delete(chunks[i].mem);
+  }
+
+  // bytes байт с выравниванием align (степень двойки)
+  void* allocate(size_t bytes, size_t align)
+  {
+    for (; cur < chunks.size(); cur++, used = 0)
+    {
+      const TChunk& c = chunks[cur];
+      const uintptr_t base = reinterpret_cast<uintptr_t>(c.mem);
+      const size_t offset = ((base + used + align - 1) & ~uintptr_t(align - 1)) - base;
+      if (offset + bytes <= c.size)
+      {
+        used = offset + bytes;
+        return c.mem + offset;
+      }
+    }
+    // ни один из оставшихся блоков не подошёл - новый блок в конец списка
+    TChunk c;
+    c.size = std::max(chunk_size, bytes + align);
+    c.mem = static_cast<char*>(::operator new(c.size));
+    chunks.push_back(c);
+    cur = chunks.size() - 1;
+    used = 0;
+    return allocate(bytes, align);
+  }
+
+  TMarker mark() const noexcept { return TMarker{ cur, used }; }
+  // память, выделенная после отметки m, считается свободной
+  void rewind(const TMarker& m) noexcept
+  {
+    cur = m.chunk;
+    used = m.offset;
+  }
+  void reset() noexcept { rewind(TMarker{ 0, 0 }); }
+
+  // число блоков и их общий размер в байтах
+  size_t block_count() const noexcept { return chunks.size(); }
+  size_t capacity() const noexcept
+  {
+    size_t s = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+      s += chunks[i].size;
+    return s;
+  }
+
+  // арена самой внутренней активной области TArenaScope этого потока
+  static TMatrixArena* current() noexcept { return current_ref(); }
+};
+
+// Область арены -
+// запоминает положение арены и откатывает её при выходе из области.
+// Пока область активна, арена является текущей для потока, и
+// распределители TArenaAllocator, созданные по умолчанию, берут память
+// из неё. Объекты на памяти арены не должны переживать область
+class TArenaScope
+{
+  TMatrixArena& arena;
+  TMatrixArena::TMarker marker;
+  TMatrixArena* prev;
+public:
+  explicit TArenaScope(TMatrixArena& a) noexcept : arena(a), marker(a.mark()), prev(TMatrixArena::current_ref())
+  {
+    TMatrixArena::current_ref() = &a;
+  }
+  TArenaScope(const TArenaScope&) = delete;
+  TArenaScope& operator=(const TArenaScope&) = delete;
+  ~TArenaScope()
+  {
+    arena.rewind(marker);
+    TMatrixArena::current_ref() = prev;
+  }
+};
+
+// Распределитель на арене -
+// блоки выравниваются на TMATRIX_ALIGNMENT байт, как у распределителя
+// по умолчанию. Освобождение блока ничего не делает, память возвращается
+// откатом арены.
+// Без арены (вне TArenaScope) память берётся из кучи
+template<typename T>
+class TArenaAllocator
+{
+  TMatrixArena* pArena;
+  template<typename U> friend class TArenaAllocator;
+public:
+  typedef T value_type;
+
+  TArenaAllocator() noexcept : pArena(TMatrixArena::current()) {}
+  explicit TArenaAllocator(TMatrixArena& a) noexcept : pArena(&a) {}
+  template<typename U>
+  TArenaAllocator(const TArenaAllocator<U>& a) noexcept : pArena(a.pArena) {}
+
+  TMatrixArena* arena() const noexcept { return pArena; }
+
+  T* allocate(size_t n)
+  {
+    const size_t align = std::max<size_t>(alignof(T), TMATRIX_ALIGNMENT);
+    if (pArena == nullptr)
+      return static_cast<T*>(aligned_allocate(n * sizeof(T), align));
+    return static_cast<T*>(pArena->allocate(n * sizeof(T), align));
+  }
+  void deallocate(T* p, size_t) noexcept
+  {
+    if (pArena == nullptr)
+      aligned_deallocate(p);
+  }
+
+  friend bool operator==(const TArenaAllocator& a, const TArenaAllocator& b) noexcept
+  {
+    return a.pArena == b.pArena;
+  }
+  friend bool operator!=(const TArenaAllocator& a, const TArenaAllocator& b) noexcept
+  {
+    return a.pArena != b.pArena;
+  }
+};
+
+// Векторы и матрицы на арене
+template<typename T>
+using TArenaVector = TDynamicVector<T, TArenaAllocator<T>>;
+template<typename T>
+using TArenaMatrix = TDynamicMatrix<T, TArenaAllocator<T>>;
+
+#endif
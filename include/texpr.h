@@ -0,0 +1,490 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Ленивые выражения над векторами и матрицами (expression templates).
+// Операторы +, - и умножение на скаляр возвращают узлы выражения,
+// которые вычисляются одним циклом при присваивании или создании объекта
+
+#ifndef __TEXPR_H__
+#define __TEXPR_H__
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "tsimd.h"
+
+// Категории выражений: тип-участник объявляет expr_category
+struct TVecExprTag {};
+struct TMatExprTag {};
+
+template<typename E, typename Tag, typename = void>
+struct TIsExpr : std::false_type {};
+template<typename E, typename Tag>
+struct TIsExpr<E, Tag, typename std::enable_if<std::is_same<typename E::expr_category, Tag>::value>::type>
+  : std::true_type {};
+
+template<typename E>
+struct TIsVecExpr : TIsExpr<E, TVecExprTag> {};
+template<typename E>
+struct TIsMatExpr : TIsExpr<E, TMatExprTag> {};
+
+// Выражение категории Tag с элементами типа T
+template<typename E, typename T, typename Tag, typename = void>
+struct TIsExprOf : std::false_type {};
+template<typename E, typename T, typename Tag>
+struct TIsExprOf<E, T, Tag, typename std::enable_if<TIsExpr<E, Tag>::value &&
+  std::is_same<typename E::value_type, T>::value>::type> : std::true_type {};
+
+// Способ хранения операнда в узле: узлы и представления копируются,
+// владеющие памятью объекты (специализации в tmatrix.h) - по ссылке
+template<typename E>
+struct TExprStore
+{
+  typedef const E type;
+};
+
+// Операнд хранит элементы подряд и даёт к ним доступ через data()
+template<typename E>
+struct TIsContiguous : std::false_type {};
+
+// Непрерывный операнд с элементами типа T - его можно передать векторному ядру
+template<typename E, typename T>
+struct TIsContiguousOf : std::integral_constant<bool,
+  TIsContiguous<E>::value && std::is_same<typename E::value_type, T>::value> {};
+
+// Векторный операнд, элементы которого лежат в памяти data() с шагом inc()
+// (представления). Векторное ядро применимо к нему при шаге 1, это
+// проверяется во время выполнения
+template<typename E>
+struct TIsStrided : std::false_type {};
+
+// Операнд в памяти (непрерывный или с шагом) с элементами типа T
+template<typename E, typename T>
+struct TIsDirectOf : std::integral_constant<bool, (TIsContiguous<E>::value || TIsStrided<E>::value) &&
+  std::is_same<typename E::value_type, T>::value> {};
+
+// шаг элементов операнда в памяти
+template<typename E>
+typename std::enable_if<TIsStrided<E>::value, size_t>::type expr_inc(const E& e) noexcept
+{
+  return e.inc();
+}
+template<typename E>
+typename std::enable_if<!TIsStrided<E>::value, size_t>::type expr_inc(const E&) noexcept
+{
+  return 1;
+}
+
+// Поэлементные операции и соответствующие им векторные ядра
+struct TOpAdd
+{
+  template<typename T>
+  static T apply(const T& a, const T& b) { return a + b; }
+  template<typename T>
+  static void (*binary(const TVecKernels<T>& k))(const T*, const T*, T*, size_t) { return k.add; }
+  template<typename T>
+  static void (*scalar(const TVecKernels<T>& k))(const T*, T, T*, size_t) { return k.add_scalar; }
+};
+struct TOpSub
+{
+  template<typename T>
+  static T apply(const T& a, const T& b) { return a - b; }
+  template<typename T>
+  static void (*binary(const TVecKernels<T>& k))(const T*, const T*, T*, size_t) { return k.sub; }
+  template<typename T>
+  static void (*scalar(const TVecKernels<T>& k))(const T*, T, T*, size_t) { return k.sub_scalar; }
+};
+struct TOpMul
+{
+  template<typename T>
+  static T apply(const T& a, const T& b) { return a * b; }
+  template<typename T>
+  static void (*scalar(const TVecKernels<T>& k))(const T*, T, T*, size_t) { return k.mul_scalar; }
+};
+
+// ---------------- векторные выражения ----------------
+
+// Поэлементная операция над двумя векторами
+template<typename L, typename R, typename Op>
+class TVecBinary
+{
+  typename TExprStore<L>::type l;
+  typename TExprStore<R>::type r;
+public:
+  typedef TVecExprTag expr_category;
+  typedef typename L::value_type value_type;
+
+  TVecBinary(const L& lhs, const R& rhs) : l(lhs), r(rhs)
+  {
+    if (l.size() != r.size())
+      throw std::length_error("Vectors should have equal size");
+  }
+
+  size_t size() const noexcept { return l.size(); }
+  value_type operator[](size_t ind) const { return Op::apply(value_type(l[ind]), value_type(r[ind])); }
+
+  const L& left() const noexcept { return l; }
+  const R& right() const noexcept { return r; }
+};
+
+// Операция вектора со скаляром
+template<typename E, typename Op>
+class TVecScalar
+{
+  typedef typename E::value_type T;
+  typename TExprStore<E>::type e;
+  T val;
+public:
+  typedef TVecExprTag expr_category;
+  typedef T value_type;
+
+  TVecScalar(const E& expr, const T& v) : e(expr), val(v) {}
+
+  size_t size() const noexcept { return e.size(); }
+  value_type operator[](size_t ind) const { return Op::apply(value_type(e[ind]), val); }
+
+  const E& expr() const noexcept { return e; }
+  const T& scalar() const noexcept { return val; }
+};
+
+// скалярные операции
+template<typename E>
+typename std::enable_if<TIsVecExpr<E>::value, TVecScalar<E, TOpAdd>>::type
+operator+(const E& e, typename E::value_type val)
+{
+  return TVecScalar<E, TOpAdd>(e, val);
+}
+template<typename E>
+typename std::enable_if<TIsVecExpr<E>::value, TVecScalar<E, TOpSub>>::type
+operator-(const E& e, typename E::value_type val)
+{
+  return TVecScalar<E, TOpSub>(e, val);
+}
+template<typename E>
+typename std::enable_if<TIsVecExpr<E>::value, TVecScalar<E, TOpMul>>::type
+operator*(const E& e, typename E::value_type val)
+{
+  return TVecScalar<E, TOpMul>(e, val);
+}
+
+// векторные операции
+template<typename L, typename R>
+typename std::enable_if<TIsVecExpr<L>::value && TIsVecExpr<R>::value, TVecBinary<L, R, TOpAdd>>::type
+operator+(const L& l, const R& r)
+{
+  return TVecBinary<L, R, TOpAdd>(l, r);
+}
+template<typename L, typename R>
+typename std::enable_if<TIsVecExpr<L>::value && TIsVecExpr<R>::value, TVecBinary<L, R, TOpSub>>::type
+operator-(const L& l, const R& r)
+{
+  return TVecBinary<L, R, TOpSub>(l, r);
+}
+
+// Вычисление векторного выражения в память dst из e.size() элементов.
+// Узел из двух операндов с шагом 1 или такого операнда и скаляра
+// вычисляется векторным ядром, остальные выражения - одним общим циклом
+template<typename T, typename E>
+void expr_loop(T* dst, const E& e)
+{
+  const size_t n = e.size();
+  for (size_t i = 0; i < n; i++)
+    dst[i] = e[i];
+}
+template<typename T, typename E>
+void expr_assign(T* dst, const E& e)
+{
+  expr_loop(dst, e);
+}
+template<typename T, typename L, typename R, typename Op>
+void expr_assign_binary(T* dst, const TVecBinary<L, R, Op>& e, std::true_type)
+{
+  if (expr_inc(e.left()) != 1 || expr_inc(e.right()) != 1)
+    expr_loop(dst, e);
+  else
+    Op::binary(vec_kernels<T>())(e.left().data(), e.right().data(), dst, e.size());
+}
+template<typename T, typename L, typename R, typename Op>
+void expr_assign_binary(T* dst, const TVecBinary<L, R, Op>& e, std::false_type)
+{
+  expr_loop(dst, e);
+}
+template<typename T, typename L, typename R, typename Op>
+void expr_assign(T* dst, const TVecBinary<L, R, Op>& e)
+{
+  expr_assign_binary(dst, e, std::integral_constant<bool, TIsDirectOf<L, T>::value &&
+    TIsDirectOf<R, T>::value>());
+}
+template<typename T, typename E, typename Op>
+void expr_assign_scalar(T* dst, const TVecScalar<E, Op>& e, std::true_type)
+{
+  if (expr_inc(e.expr()) != 1)
+    expr_loop(dst, e);
+  else
+    Op::scalar(vec_kernels<T>())(e.expr().data(), e.scalar(), dst, e.size());
+}
+template<typename T, typename E, typename Op>
+void expr_assign_scalar(T* dst, const TVecScalar<E, Op>& e, std::false_type)
+{
+  expr_loop(dst, e);
+}
+template<typename T, typename E, typename Op>
+void expr_assign(T* dst, const TVecScalar<E, Op>& e)
+{
+  expr_assign_scalar(dst, e, TIsDirectOf<E, T>());
+}
+
+// Скалярное произведение векторных выражений
+template<typename L, typename R>
+typename L::value_type expr_dot(const L& l, const R& r, std::false_type);
+template<typename L, typename R>
+typename L::value_type expr_dot(const L& l, const R& r, std::true_type)
+{
+  if (expr_inc(l) != 1 || expr_inc(r) != 1)
+    return expr_dot(l, r, std::false_type());
+  return vec_kernels<typename L::value_type>().dot(l.data(), r.data(), l.size());
+}
+template<typename L, typename R>
+typename L::value_type expr_dot(const L& l, const R& r, std::false_type)
+{
+  typedef typename L::value_type T;
+  T s0 = T(), s1 = T();
+  const size_t n = l.size();
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+  {
+    s0 += T(l[i]) * T(r[i]);
+    s1 += T(l[i + 1]) * T(r[i + 1]);
+  }
+  if (i < n)
+    s0 += T(l[i]) * T(r[i]);
+  return s0 + s1;
+}
+template<typename L, typename R>
+typename std::enable_if<TIsVecExpr<L>::value && TIsVecExpr<R>::value, typename L::value_type>::type
+operator*(const L& l, const R& r)
+{
+  if (l.size() != r.size())
+    throw std::length_error("Vectors should have equal size");
+  return expr_dot(l, r, std::integral_constant<bool, TIsDirectOf<L, typename L::value_type>::value &&
+    TIsDirectOf<R, typename L::value_type>::value>());
+}
+
+// ---------------- порядок хранения матриц ----------------
+// Параметр Layout у TDynamicMatrix: lead(m, n, a) - ведущая размерность ld
+// с дополнением до кратной a элементам, storage(m, n, ld) - число элементов
+// памяти, index(i, j, ld) - положение элемента (i, j)
+
+// по строкам (по умолчанию): строка i начинается с i * ld
+struct TRowMajor
+{
+  static size_t lead(size_t, size_t n, size_t a) noexcept { return (n + a - 1) / a * a; }
+  static size_t storage(size_t m, size_t, size_t ld) noexcept { return m * ld; }
+  static size_t index(size_t i, size_t j, size_t ld) noexcept { return i * ld + j; }
+};
+// по столбцам, как в Fortran и LAPACK: столбец j начинается с j * ld
+struct TColMajor
+{
+  static size_t lead(size_t m, size_t, size_t a) noexcept { return (m + a - 1) / a * a; }
+  static size_t storage(size_t, size_t n, size_t ld) noexcept { return n * ld; }
+  static size_t index(size_t i, size_t j, size_t ld) noexcept { return j * ld + i; }
+};
+// блоками B x B: блоки одной строки блоков лежат подряд и занимают ld
+// элементов, внутри блока элементы хранятся по строкам
+template<size_t B = 32>
+struct TTiled
+{
+  static const size_t BLOCK = B;
+  static size_t lead(size_t, size_t n, size_t) noexcept { return (n + B - 1) / B * (B * B); }
+  static size_t storage(size_t m, size_t, size_t ld) noexcept { return (m + B - 1) / B * ld; }
+  static size_t index(size_t i, size_t j, size_t ld) noexcept
+  {
+    return i / B * ld + j / B * (B * B) + i % B * B + j % B;
+  }
+};
+template<size_t B> const size_t TTiled<B>::BLOCK;
+// операнды выражения хранятся в разном порядке
+struct TMixedLayout {};
+
+// Порядок хранения операнда: тип объявляет layout_type, остальные
+// матричные операнды (представления, отображённые матрицы) хранятся по строкам
+template<typename E, typename = void>
+struct TExprLayout
+{
+  typedef TRowMajor type;
+};
+template<typename E>
+struct TExprLayout<E, typename std::enable_if<std::is_class<typename E::layout_type>::value>::type>
+{
+  typedef typename E::layout_type type;
+};
+template<typename L1, typename L2>
+struct TCommonLayout
+{
+  typedef TMixedLayout type;
+};
+template<typename L>
+struct TCommonLayout<L, L>
+{
+  typedef L type;
+};
+
+// ---------------- матричные выражения ----------------
+// Матричный операнд сообщает число строк rows() и столбцов cols()
+// и даёт элемент operator()(i, j)
+
+// Поэлементная операция над двумя матрицами
+template<typename L, typename R, typename Op>
+class TMatBinary
+{
+  typename TExprStore<L>::type l;
+  typename TExprStore<R>::type r;
+public:
+  typedef TMatExprTag expr_category;
+  typedef typename L::value_type value_type;
+  typedef typename TCommonLayout<typename TExprLayout<L>::type, typename TExprLayout<R>::type>::type layout_type;
+
+  TMatBinary(const L& lhs, const R& rhs) : l(lhs), r(rhs)
+  {
+    if (l.rows() != r.rows() || l.cols() != r.cols())
+      throw std::length_error("Matrices should have equal size");
+  }
+
+  size_t rows() const noexcept { return l.rows(); }
+  size_t cols() const noexcept { return l.cols(); }
+  value_type operator()(size_t i, size_t j) const { return Op::apply(l(i, j), r(i, j)); }
+
+  const L& left() const noexcept { return l; }
+  const R& right() const noexcept { return r; }
+};
+
+// Операция матрицы со скаляром
+template<typename E, typename Op>
+class TMatScalar
+{
+  typedef typename E::value_type T;
+  typename TExprStore<E>::type e;
+  T val;
+public:
+  typedef TMatExprTag expr_category;
+  typedef T value_type;
+  typedef typename TExprLayout<E>::type layout_type;
+
+  TMatScalar(const E& expr, const T& v) : e(expr), val(v) {}
+
+  size_t rows() const noexcept { return e.rows(); }
+  size_t cols() const noexcept { return e.cols(); }
+  value_type operator()(size_t i, size_t j) const { return Op::apply(e(i, j), val); }
+
+  const E& expr() const noexcept { return e; }
+  const T& scalar() const noexcept { return val; }
+};
+
+// матрично-скалярные операции
+template<typename E>
+typename std::enable_if<TIsMatExpr<E>::value, TMatScalar<E, TOpMul>>::type
+operator*(const E& e, typename E::value_type val)
+{
+  return TMatScalar<E, TOpMul>(e, val);
+}
+
+// матрично-матричные операции
+template<typename L, typename R>
+typename std::enable_if<TIsMatExpr<L>::value && TIsMatExpr<R>::value, TMatBinary<L, R, TOpAdd>>::type
+operator+(const L& l, const R& r)
+{
+  return TMatBinary<L, R, TOpAdd>(l, r);
+}
+template<typename L, typename R>
+typename std::enable_if<TIsMatExpr<L>::value && TIsMatExpr<R>::value, TMatBinary<L, R, TOpSub>>::type
+operator-(const L& l, const R& r)
+{
+  return TMatBinary<L, R, TOpSub>(l, r);
+}
+
+// Сторона квадратного блока обхода: блок источника и блок приёмника
+// вместе помещаются в кэш первого уровня
+const size_t TRANSPOSE_BLOCK = 32;
+
+// Вычисление матричного выражения в построчно хранимую память dst
+// с шагом строк ld. Узлы над непрерывно хранимыми матрицами вычисляются
+// векторным ядром по строкам, строка операнда начинается с data() + i * stride().
+// Выражение с операндами, хранимыми не по строкам, обходится блоками
+// TRANSPOSE_BLOCK x TRANSPOSE_BLOCK: обращения с шагом остаются в кэше
+template<typename T, typename E>
+void expr_loop_matrix_layout(T* dst, size_t ld, const E& e, std::true_type)
+{
+  const size_t m = e.rows(), n = e.cols();
+  for (size_t i = 0; i < m; i++)
+  {
+    T* d = dst + i * ld;
+    for (size_t j = 0; j < n; j++)
+      d[j] = e(i, j);
+  }
+}
+template<typename T, typename E>
+void expr_loop_matrix_layout(T* dst, size_t ld, const E& e, std::false_type)
+{
+  const size_t m = e.rows(), n = e.cols();
+  for (size_t i0 = 0; i0 < m; i0 += TRANSPOSE_BLOCK)
+    for (size_t j0 = 0; j0 < n; j0 += TRANSPOSE_BLOCK)
+    {
+      const size_t i1 = std::min(i0 + TRANSPOSE_BLOCK, m), j1 = std::min(j0 + TRANSPOSE_BLOCK, n);
+      for (size_t i = i0; i < i1; i++)
+        for (size_t j = j0; j < j1; j++)
+          dst[i * ld + j] = e(i, j);
+    }
+}
+template<typename T, typename E>
+void expr_loop_matrix(T* dst, size_t ld, const E& e)
+{
+  expr_loop_matrix_layout(dst, ld, e, std::is_same<typename TExprLayout<E>::type, TRowMajor>());
+}
+template<typename T, typename E>
+void expr_assign_matrix(T* dst, size_t ld, const E& e)
+{
+  expr_loop_matrix(dst, ld, e);
+}
+template<typename T, typename L, typename R, typename Op>
+void expr_assign_matrix_binary(T* dst, size_t ld, const TMatBinary<L, R, Op>& e, std::true_type)
+{
+  const auto f = Op::binary(vec_kernels<T>());
+  const L& l = e.left();
+  const R& r = e.right();
+  const size_t m = e.rows(), n = e.cols();
+  for (size_t i = 0; i < m; i++)
+    f(l.data() + i * l.stride(), r.data() + i * r.stride(), dst + i * ld, n);
+}
+template<typename T, typename L, typename R, typename Op>
+void expr_assign_matrix_binary(T* dst, size_t ld, const TMatBinary<L, R, Op>& e, std::false_type)
+{
+  expr_loop_matrix(dst, ld, e);
+}
+template<typename T, typename L, typename R, typename Op>
+void expr_assign_matrix(T* dst, size_t ld, const TMatBinary<L, R, Op>& e)
+{
+  expr_assign_matrix_binary(dst, ld, e, std::integral_constant<bool, TIsContiguousOf<L, T>::value &&
+    TIsContiguousOf<R, T>::value>());
+}
+template<typename T, typename E, typename Op>
+void expr_assign_matrix_scalar(T* dst, size_t ld, const TMatScalar<E, Op>& e, std::true_type)
+{
+  const auto f = Op::scalar(vec_kernels<T>());
+  const E& a = e.expr();
+  const size_t m = e.rows(), n = e.cols();
+  for (size_t i = 0; i < m; i++)
+    f(a.data() + i * a.stride(), e.scalar(), dst + i * ld, n);
+}
+template<typename T, typename E, typename Op>
+void expr_assign_matrix_scalar(T* dst, size_t ld, const TMatScalar<E, Op>& e, std::false_type)
+{
+  expr_loop_matrix(dst, ld, e);
+}
+template<typename T, typename E, typename Op>
+void expr_assign_matrix(T* dst, size_t ld, const TMatScalar<E, Op>& e)
+{
+  expr_assign_matrix_scalar(dst, ld, e, TIsContiguousOf<E, T>());
+}
+
+#endif
@@ -0,0 +1,523 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Ядра умножения матриц, хранящихся построчно в непрерывной памяти
+
+#ifndef __TGEMM_H__
+#define __TGEMM_H__
+
+#include <algorithm>
+#include <memory>
+
+#include "tsimd.h"
+
+// Размеры кэшей в байтах. Значения по умолчанию рассчитаны на типичный
+// серверный x86 и могут быть переопределены при сборке
+#ifndef TMATRIX_L1_CACHE_SIZE
+#define TMATRIX_L1_CACHE_SIZE (32 * 1024)
+#endif
+#ifndef TMATRIX_L2_CACHE_SIZE
+#define TMATRIX_L2_CACHE_SIZE (1024 * 1024)
+#endif
+#ifndef TMATRIX_L3_CACHE_SIZE
+#define TMATRIX_L3_CACHE_SIZE (8 * 1024 * 1024)
+#endif
+
+// размер блока не меньше минимального (для типов большого размера)
+constexpr size_t gemm_block_size(size_t s, size_t min_s)
+{
+  return s > min_s ? s : min_s;
+}
+
+// Размеры блоков для умножения C += A * B:
+// NC - ширина полосы столбцов B и C: MR строк полосы C и строка панели B
+//      вместе занимают не больше половины L1;
+// KC - высота упакованной панели B (KC x NC), панель занимает половину L2;
+// MC - высота блока строк C (MC x NC), блок занимает половину L3
+template<typename T>
+struct TGemmBlocking
+{
+  // число строк C, обновляемых за один проход по строке панели B
+  static const size_t MR = 4;
+  static const size_t NC = gemm_block_size(TMATRIX_L1_CACHE_SIZE / (2 * (MR + 1) * sizeof(T)) / 16 * 16, 16);
+  static const size_t KC = gemm_block_size(TMATRIX_L2_CACHE_SIZE / (2 * NC * sizeof(T)), 1);
+  static const size_t MC = gemm_block_size(TMATRIX_L3_CACHE_SIZE / (2 * NC * sizeof(T)), MR);
+};
+template<typename T> const size_t TGemmBlocking<T>::MR;
+template<typename T> const size_t TGemmBlocking<T>::NC;
+template<typename T> const size_t TGemmBlocking<T>::KC;
+template<typename T> const size_t TGemmBlocking<T>::MC;
+
+// Рабочий буфер для упаковки панелей: свой у каждого потока и каждого
+// слота, растёт по мере надобности и не освобождается между умножениями,
+// поэтому повторные умножения не выделяют память
+template<typename T, int Slot>
+T* gemm_workspace(size_t count)
+{
+  static thread_local std::unique_ptr<T[]> buf;
+  static thread_local size_t cap = 0;
+  if (cap < count)
+  {
+    buf.reset(new T[count]);
+    cap = count;
+  }
+  return buf.get();
+}
+
+// Упаковка блока B (kc x nc, шаг строк ldb) в непрерывную панель,
+// элементы умножаются на alpha
+template<typename T>
+void gemm_pack_b(size_t kc, size_t nc, const T* B, size_t ldb, T* Bp, const T& alpha = T(1))
+{
+  for (size_t p = 0; p < kc; p++)
+    for (size_t j = 0; j < nc; j++)
+      Bp[p * nc + j] = alpha * B[p * ldb + j];
+}
+
+// C[mr x nc] += A[mr x kc] * Bp[kc x nc] для mr <= MR строк
+template<typename T>
+void gemm_rows(size_t mr, size_t nc, size_t kc, const T* A, size_t lda, const T* Bp, T* C, size_t ldc)
+{
+  if (mr == 4)
+  {
+    T* c0 = C;
+    T* c1 = C + ldc;
+    T* c2 = C + 2 * ldc;
+    T* c3 = C + 3 * ldc;
+    for (size_t p = 0; p < kc; p++)
+    {
+      const T a0 = A[p], a1 = A[lda + p], a2 = A[2 * lda + p], a3 = A[3 * lda + p];
+      const T* b = Bp + p * nc;
+      for (size_t j = 0; j < nc; j++)
+      {
+        const T bj = b[j];
+        c0[j] += a0 * bj;
+        c1[j] += a1 * bj;
+        c2[j] += a2 * bj;
+        c3[j] += a3 * bj;
+      }
+    }
+    return;
+  }
+  for (size_t r = 0; r < mr; r++)
+  {
+    T* c = C + r * ldc;
+    for (size_t p = 0; p < kc; p++)
+    {
+      const T a = A[r * lda + p];
+      const T* b = Bp + p * nc;
+      for (size_t j = 0; j < nc; j++)
+        c[j] += a * b[j];
+    }
+  }
+}
+
+// Блочное умножение C[m x n] += alpha * A[m x k] * B[k x n].
+// ld* - расстояние между началами соседних строк в элементах
+template<typename T>
+void gemm_blocked(size_t m, size_t n, size_t k, const T& alpha,
+  const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc)
+{
+  typedef TGemmBlocking<T> BS;
+  T* Bp = gemm_workspace<T, 0>(std::min(k, BS::KC) * std::min(n, BS::NC));
+  for (size_t jc = 0; jc < n; jc += BS::NC)
+  {
+    const size_t nc = std::min(BS::NC, n - jc);
+    for (size_t pc = 0; pc < k; pc += BS::KC)
+    {
+      const size_t kc = std::min(BS::KC, k - pc);
+      gemm_pack_b(kc, nc, B + pc * ldb + jc, ldb, Bp, alpha);
+      for (size_t ic = 0; ic < m; ic += BS::MC)
+      {
+        const size_t mc = std::min(BS::MC, m - ic);
+        for (size_t i = 0; i < mc; i += BS::MR)
+        {
+          const size_t mr = std::min(BS::MR, mc - i);
+          gemm_rows(mr, nc, kc, A + (ic + i) * lda + pc, lda, Bp,
+            C + (ic + i) * ldc + jc, ldc);
+        }
+      }
+    }
+  }
+}
+
+// Упакованное умножение для float и double (схема BLIS):
+// блоки A и B копируются в непрерывные микропанели, а блок C размером
+// MR x NR накапливается в регистрах микроядра.
+// KC - глубина микропанелей, микропанель B (KC x NR) занимает половину L1;
+// MC - высота блока A (MC x KC), блок занимает половину L2;
+// NC - ширина блока B (KC x NC), блок занимает половину L3
+template<typename T>
+struct TGemmPacked
+{
+  static const size_t MR = 6;
+  static const size_t NR = 64 / sizeof(T);
+  static const size_t KC = gemm_block_size(TMATRIX_L1_CACHE_SIZE / (2 * NR * sizeof(T)), 1);
+  static const size_t MC = gemm_block_size(TMATRIX_L2_CACHE_SIZE / (2 * KC * sizeof(T)) / MR * MR, MR);
+  static const size_t NC = gemm_block_size(TMATRIX_L3_CACHE_SIZE / (2 * KC * sizeof(T)) / NR * NR, NR);
+
+  // микроядро: C[MR x NR] += A[MR x kc] * B[kc x NR] по упакованным панелям
+  typedef void (*TMicroKernel)(size_t kc, const T* Ap, const T* Bp, T* C, size_t ldc);
+};
+template<typename T> const size_t TGemmPacked<T>::MR;
+template<typename T> const size_t TGemmPacked<T>::NR;
+template<typename T> const size_t TGemmPacked<T>::KC;
+template<typename T> const size_t TGemmPacked<T>::MC;
+template<typename T> const size_t TGemmPacked<T>::NC;
+
+// Упаковка блока A (mc x kc) в микропанели по MR строк: внутри микропанели
+// элементы столбца p лежат подряд и умножаются на alpha.
+// Неполная последняя панель дополняется нулями
+template<typename T>
+void gemm_pack_a_panels(size_t mc, size_t kc, const T* A, size_t lda, T* Ap, const T& alpha = T(1))
+{
+  const size_t MR = TGemmPacked<T>::MR;
+  for (size_t ir = 0; ir < mc; ir += MR)
+  {
+    const size_t mr = std::min(MR, mc - ir);
+    for (size_t p = 0; p < kc; p++)
+    {
+      for (size_t r = 0; r < mr; r++)
+        Ap[r] = alpha * A[(ir + r) * lda + p];
+      for (size_t r = mr; r < MR; r++)
+        Ap[r] = T();
+      Ap += MR;
+    }
+  }
+}
+
+// Упаковка блока B (kc x nc) в микропанели по NR столбцов: внутри микропанели
+// элементы строки p лежат подряд. Неполная последняя панель дополняется нулями
+template<typename T>
+void gemm_pack_b_panels(size_t kc, size_t nc, const T* B, size_t ldb, T* Bp)
+{
+  const size_t NR = TGemmPacked<T>::NR;
+  for (size_t jr = 0; jr < nc; jr += NR)
+  {
+    const size_t nr = std::min(NR, nc - jr);
+    for (size_t p = 0; p < kc; p++)
+    {
+      const T* b = B + p * ldb + jr;
+      for (size_t c = 0; c < nr; c++)
+        Bp[c] = b[c];
+      for (size_t c = nr; c < NR; c++)
+        Bp[c] = T();
+      Bp += NR;
+    }
+  }
+}
+
+// Переносимое микроядро, цикл по столбцам векторизуется компилятором
+template<typename T>
+void gemm_ukernel_portable(size_t kc, const T* Ap, const T* Bp, T* C, size_t ldc)
+{
+  const size_t MR = TGemmPacked<T>::MR, NR = TGemmPacked<T>::NR;
+  T acc[MR][NR] = {};
+  for (size_t p = 0; p < kc; p++)
+  {
+    for (size_t r = 0; r < MR; r++)
+    {
+      const T a = Ap[r];
+      for (size_t c = 0; c < NR; c++)
+        acc[r][c] += a * Bp[c];
+    }
+    Ap += MR;
+    Bp += NR;
+  }
+  for (size_t r = 0; r < MR; r++)
+    for (size_t c = 0; c < NR; c++)
+      C[r * ldc + c] += acc[r][c];
+}
+
+#ifdef TMATRIX_X86
+// Микроядра AVX2+FMA 6 x 8 (double) и 6 x 16 (float):
+// 12 регистров-аккумуляторов, 2 регистра под строку панели B, 1 под элемент A
+inline TMATRIX_TARGET("avx2,fma")
+void gemm_ukernel_avx2(size_t kc, const double* Ap, const double* Bp, double* C, size_t ldc)
+{
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+  __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+  for (size_t p = 0; p < kc; p++)
+  {
+    const __m256d b0 = _mm256_loadu_pd(Bp);
+    const __m256d b1 = _mm256_loadu_pd(Bp + 4);
+    __m256d a;
+    a = _mm256_broadcast_sd(Ap);
+    c00 = _mm256_fmadd_pd(a, b0, c00); c01 = _mm256_fmadd_pd(a, b1, c01);
+    a = _mm256_broadcast_sd(Ap + 1);
+    c10 = _mm256_fmadd_pd(a, b0, c10); c11 = _mm256_fmadd_pd(a, b1, c11);
+    a = _mm256_broadcast_sd(Ap + 2);
+    c20 = _mm256_fmadd_pd(a, b0, c20); c21 = _mm256_fmadd_pd(a, b1, c21);
+    a = _mm256_broadcast_sd(Ap + 3);
+    c30 = _mm256_fmadd_pd(a, b0, c30); c31 = _mm256_fmadd_pd(a, b1, c31);
+    a = _mm256_broadcast_sd(Ap + 4);
+    c40 = _mm256_fmadd_pd(a, b0, c40); c41 = _mm256_fmadd_pd(a, b1, c41);
+    a = _mm256_broadcast_sd(Ap + 5);
+    c50 = _mm256_fmadd_pd(a, b0, c50); c51 = _mm256_fmadd_pd(a, b1, c51);
+    Ap += 6;
+    Bp += 8;
+  }
+  const __m256d acc[6][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 },
+                              { c30, c31 }, { c40, c41 }, { c50, c51 } };
+  for (size_t r = 0; r < 6; r++)
+  {
+    double* c = C + r * ldc;
+    _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), acc[r][0]));
+    _mm256_storeu_pd(c + 4, _mm256_add_pd(_mm256_loadu_pd(c + 4), acc[r][1]));
+  }
+}
+
+inline TMATRIX_TARGET("avx2,fma")
+void gemm_ukernel_avx2(size_t kc, const float* Ap, const float* Bp, float* C, size_t ldc)
+{
+  __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+  __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+  __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+  __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+  __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+  __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+  for (size_t p = 0; p < kc; p++)
+  {
+    const __m256 b0 = _mm256_loadu_ps(Bp);
+    const __m256 b1 = _mm256_loadu_ps(Bp + 8);
+    __m256 a;
+    a = _mm256_broadcast_ss(Ap);
+    c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+    a = _mm256_broadcast_ss(Ap + 1);
+    c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+    a = _mm256_broadcast_ss(Ap + 2);
+    c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+    a = _mm256_broadcast_ss(Ap + 3);
+    c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+    a = _mm256_broadcast_ss(Ap + 4);
+    c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+    a = _mm256_broadcast_ss(Ap + 5);
+    c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+    Ap += 6;
+    Bp += 16;
+  }
+  const __m256 acc[6][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 },
+                             { c30, c31 }, { c40, c41 }, { c50, c51 } };
+  for (size_t r = 0; r < 6; r++)
+  {
+    float* c = C + r * ldc;
+    _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), acc[r][0]));
+    _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), acc[r][1]));
+  }
+}
+#endif
+
+// Выбор микроядра выполняется один раз при первом умножении
+template<typename T>
+typename TGemmPacked<T>::TMicroKernel gemm_select_ukernel()
+{
+#ifdef TMATRIX_X86
+  if (cpu_features().avx2 && cpu_features().fma)
+    return static_cast<typename TGemmPacked<T>::TMicroKernel>(&gemm_ukernel_avx2);
+#endif
+  return &gemm_ukernel_portable<T>;
+}
+
+// Упакованное умножение C[m x n] += alpha * A[m x k] * B[k x n] для float и double
+template<typename T>
+void gemm_packed(size_t m, size_t n, size_t k, const T& alpha,
+  const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc)
+{
+  typedef TGemmPacked<T> BS;
+  static const typename BS::TMicroKernel ukernel = gemm_select_ukernel<T>();
+
+  const size_t kcmax = std::min(k, BS::KC);
+  const size_t mcmax = (std::min(m, BS::MC) + BS::MR - 1) / BS::MR * BS::MR;
+  const size_t ncmax = (std::min(n, BS::NC) + BS::NR - 1) / BS::NR * BS::NR;
+  T* Ap = gemm_workspace<T, 0>(mcmax * kcmax);
+  T* Bp = gemm_workspace<T, 1>(kcmax * ncmax);
+  T edge[BS::MR * BS::NR];
+
+  for (size_t jc = 0; jc < n; jc += BS::NC)
+  {
+    const size_t nc = std::min(BS::NC, n - jc);
+    for (size_t pc = 0; pc < k; pc += BS::KC)
+    {
+      const size_t kc = std::min(BS::KC, k - pc);
+      gemm_pack_b_panels(kc, nc, B + pc * ldb + jc, ldb, Bp);
+      for (size_t ic = 0; ic < m; ic += BS::MC)
+      {
+        const size_t mc = std::min(BS::MC, m - ic);
+        gemm_pack_a_panels(mc, kc, A + ic * lda + pc, lda, Ap, alpha);
+        for (size_t jr = 0; jr < nc; jr += BS::NR)
+        {
+          const size_t nr = std::min(BS::NR, nc - jr);
+          const T* bp = Bp + jr * kc;
+          for (size_t ir = 0; ir < mc; ir += BS::MR)
+          {
+            const size_t mr = std::min(BS::MR, mc - ir);
+            const T* ap = Ap + ir * kc;
+            T* c = C + (ic + ir) * ldc + jc + jr;
+            if (mr == BS::MR && nr == BS::NR)
+            {
+              ukernel(kc, ap, bp, c, ldc);
+              continue;
+            }
+            // краевой блок считается во временном буфере
+            std::fill(edge, edge + BS::MR * BS::NR, T());
+            ukernel(kc, ap, bp, edge, BS::NR);
+            for (size_t r = 0; r < mr; r++)
+              for (size_t j = 0; j < nr; j++)
+                c[r * ldc + j] += edge[r * BS::NR + j];
+          }
+        }
+      }
+    }
+  }
+}
+
+// Ядро умножения C += alpha * A * B: упакованное для float и double,
+// блочное переносимое для остальных типов
+template<typename T>
+struct TGemmKernel
+{
+  static void run(size_t m, size_t n, size_t k, const T& alpha,
+    const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc)
+  {
+    gemm_blocked(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+  }
+};
+template<>
+struct TGemmKernel<float>
+{
+  static void run(size_t m, size_t n, size_t k, float alpha,
+    const float* A, size_t lda, const float* B, size_t ldb, float* C, size_t ldc)
+  {
+    gemm_packed(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+  }
+};
+template<>
+struct TGemmKernel<double>
+{
+  static void run(size_t m, size_t n, size_t k, double alpha,
+    const double* A, size_t lda, const double* B, size_t ldb, double* C, size_t ldc)
+  {
+    gemm_packed(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+  }
+};
+
+// ---------------- выбор ядра по форме матриц ----------------
+
+// Наибольшее число столбцов C, при котором C = A * B считается скалярными
+// произведениями: упакованное ядро тратило бы полную ширину микропанели
+// на несколько столбцов
+const size_t GEMM_NARROW_COLS = 4;
+
+// C = beta * C для блока m x n; при beta = 0 прежние значения не читаются
+template<typename T>
+void gemm_scale(size_t m, size_t n, const T& beta, T* C, size_t ldc)
+{
+  if (beta == T(1))
+    return;
+  const TVecKernels<T>& vk = vec_kernels<T>();
+  for (size_t i = 0; i < m; i++)
+    if (beta == T())
+      std::fill(C + i * ldc, C + i * ldc + n, T());
+    else
+      vk.mul_scalar(C + i * ldc, beta, C + i * ldc, n);
+}
+
+// Узкий результат (n <= GEMM_NARROW_COLS): B транспонируется в рабочий
+// буфер, c[i][j] - скалярное произведение строки A на строку B^T.
+// A читается из памяти один раз
+template<typename T>
+void gemm_narrow(size_t m, size_t n, size_t k, const T& alpha,
+  const T* A, size_t lda, const T* B, size_t ldb, const T& beta, T* C, size_t ldc)
+{
+  const TVecKernels<T>& vk = vec_kernels<T>();
+  T* Bt = gemm_workspace<T, 1>(n * k);
+  for (size_t p = 0; p < k; p++)
+    for (size_t j = 0; j < n; j++)
+      Bt[j * k + p] = B[p * ldb + j];
+  for (size_t i = 0; i < m; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      const T s = alpha * vk.dot(A + i * lda, Bt + j * k, k);
+      T& c = C[i * ldc + j];
+      c = beta == T() ? s : s + beta * c;
+    }
+}
+
+// Низкий результат (m <= TGemmBlocking<T>::MR): полосы C шириной NC,
+// помещающиеся в L1, обновляются строками B. Каждая строка B читается
+// из памяти один раз и без упаковки
+template<typename T>
+void gemm_short(size_t m, size_t n, size_t k, const T& alpha,
+  const T* A, size_t lda, const T* B, size_t ldb, const T& beta, T* C, size_t ldc)
+{
+  const size_t NC = TGemmBlocking<T>::NC;
+  const TVecKernels<T>& vk = vec_kernels<T>();
+  for (size_t jc = 0; jc < n; jc += NC)
+  {
+    const size_t nc = std::min(NC, n - jc);
+    gemm_scale(m, nc, beta, C + jc, ldc);
+    for (size_t p = 0; p < k; p++)
+      for (size_t i = 0; i < m; i++)
+        vk.axpy(alpha * A[i * lda + p], B + p * ldb + jc, C + i * ldc + jc, nc);
+  }
+}
+
+// Малая внутренняя размерность (k <= KC): ядро проходит C один раз, и
+// отдельный проход beta * C по всей матрице удвоил бы обмен с памятью.
+// C делится на панели в четверть L2 - полосы строк у высокой узкой
+// матрицы, полосы столбцов у низкой широкой; beta применяется к панели
+// непосредственно перед ядром, пока панель в кэше. Высота и ширина панели
+// кратны размерам микропанелей ядер
+template<typename T>
+void gemm_paneled(size_t m, size_t n, size_t k, const T& alpha,
+  const T* A, size_t lda, const T* B, size_t ldb, const T& beta, T* C, size_t ldc)
+{
+  const size_t panel = TMATRIX_L2_CACHE_SIZE / (4 * sizeof(T));
+  if (m >= n)
+  {
+    const size_t h = gemm_block_size(panel / n / 12 * 12, 12);
+    for (size_t i = 0; i < m; i += h)
+    {
+      const size_t mc = std::min(h, m - i);
+      gemm_scale(mc, n, beta, C + i * ldc, ldc);
+      TGemmKernel<T>::run(mc, n, k, alpha, A + i * lda, lda, B, ldb, C + i * ldc, ldc);
+    }
+    return;
+  }
+  const size_t w = gemm_block_size(panel / m / 16 * 16, 16);
+  for (size_t j = 0; j < n; j += w)
+  {
+    const size_t nc = std::min(w, n - j);
+    gemm_scale(m, nc, beta, C + j, ldc);
+    TGemmKernel<T>::run(m, nc, k, alpha, A, lda, B + j, ldb, C + j, ldc);
+  }
+}
+
+// C = alpha * A * B + beta * C для A (m x k), B (k x n), C (m x n);
+// при beta = 0 прежнее значение C не читается. Узкий и низкий результат
+// считаются векторными ядрами, при малой внутренней размерности C
+// обрабатывается панелями, иначе - упакованным или блочным ядром.
+// C не пересекается с A и B
+template<typename T>
+void gemm_shaped(size_t m, size_t n, size_t k, const T& alpha,
+  const T* A, size_t lda, const T* B, size_t ldb, const T& beta, T* C, size_t ldc)
+{
+  if (n <= GEMM_NARROW_COLS)
+    gemm_narrow(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+  else if (m <= TGemmBlocking<T>::MR)
+    gemm_short(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+  else if (k <= TGemmPacked<T>::KC)
+    gemm_paneled(m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+  else
+  {
+    gemm_scale(m, n, beta, C, ldc);
+    TGemmKernel<T>::run(m, n, k, alpha, A, lda, B, ldb, C, ldc);
+  }
+}
+
+#endif
@@ -0,0 +1,507 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Матрицы, хранимые по столбцам и блоками.
+// Матрица, хранимая по столбцам, в памяти совпадает с транспонированной
+// матрицей, хранимой по строкам. Поэтому выражения над такими матрицами
+// вычисляются транспонированными: векторные ядра и ядро умножения идут
+// по столбцам подряд, без копирования. Выражения со смешанным порядком
+// хранения обходятся блоками, а преобразование порядка выполняется
+// блочным транспонированием
+
+#ifndef __TLayout_H__
+#define __TLayout_H__
+
+#include "tview.h"
+
+// Строка матрицы с порядком хранения Layout -
+// доступ к элементам строки i без копирования. Строка участвует
+// в векторных выражениях; строка матрицы, хранимой по столбцам, -
+// операнд с шагом stride() матрицы
+template<typename T, typename Layout>
+class TLayoutRow
+{
+  T* pMem;
+  size_t row;
+  size_t ld;
+  size_t sz;
+public:
+  typedef TVecExprTag expr_category;
+  typedef typename std::remove_const<T>::type value_type;
+
+  TLayoutRow(T* p, size_t i, size_t stride, size_t size) noexcept : pMem(p), row(i), ld(stride), sz(size) {}
+
+  size_t size() const noexcept { return sz; }
+  // память строки с шагом inc() - только для порядка TColMajor
+  T* data() const noexcept
+  {
+    static_assert(std::is_same<Layout, TColMajor>::value, "Only column-major rows have a constant step");
+    return pMem + row;
+  }
+  size_t inc() const noexcept
+  {
+    static_assert(std::is_same<Layout, TColMajor>::value, "Only column-major rows have a constant step");
+    return ld;
+  }
+
+  // индексация
+  T& operator[](size_t ind) const noexcept
+  {
+    return pMem[Layout::index(row, ind, ld)];
+  }
+  // индексация с контролем
+  T& at(size_t ind) const
+  {
+    if (ind >= sz)
+      throw out_of_range("Row index is out of range");
+    return (*this)[ind];
+  }
+};
+
+template<typename T>
+struct TIsStrided<TLayoutRow<T, TColMajor>> : std::true_type {};
+
+// порядок хранения транспонированного выражения
+template<typename Layout>
+struct TTransposedLayout
+{
+  typedef TMixedLayout type;
+};
+template<>
+struct TTransposedLayout<TRowMajor>
+{
+  typedef TColMajor type;
+};
+template<>
+struct TTransposedLayout<TColMajor>
+{
+  typedef TRowMajor type;
+};
+
+// Транспонированное выражение: элемент (i, j) равен e(j, i)
+template<typename E>
+class TMatTransposed
+{
+  typename TExprStore<E>::type e;
+public:
+  typedef TMatExprTag expr_category;
+  typedef typename E::value_type value_type;
+  typedef typename TTransposedLayout<typename TExprLayout<E>::type>::type layout_type;
+
+  explicit TMatTransposed(const E& expr) : e(expr) {}
+
+  size_t rows() const noexcept { return e.cols(); }
+  size_t cols() const noexcept { return e.rows(); }
+  value_type operator()(size_t i, size_t j) const { return e(j, i); }
+
+  const E& expr() const noexcept { return e; }
+};
+
+// Построение транспонированного выражения:
+// матрица, хранимая по столбцам, становится представлением своей памяти,
+// хранимым по строкам; узлы транспонируются поэлементно, (A * B)^T = B^T * A^T;
+// остальные операнды читаются через TMatTransposed
+template<typename E>
+struct TExprTranspose
+{
+  typedef TMatTransposed<E> type;
+  static type make(const E& e) { return type(e); }
+};
+template<typename T, typename A>
+struct TExprTranspose<TDynamicMatrix<T, A, TColMajor>>
+{
+  typedef TMatrixView<const T> type;
+  static type make(const TDynamicMatrix<T, A, TColMajor>& m)
+  {
+    return type(m.data(), m.cols(), m.rows(), m.stride());
+  }
+};
+template<typename L, typename R, typename Op>
+struct TExprTranspose<TMatBinary<L, R, Op>>
+{
+  typedef TMatBinary<typename TExprTranspose<L>::type, typename TExprTranspose<R>::type, Op> type;
+  static type make(const TMatBinary<L, R, Op>& e)
+  {
+    return type(TExprTranspose<L>::make(e.left()), TExprTranspose<R>::make(e.right()));
+  }
+};
+template<typename E, typename Op>
+struct TExprTranspose<TMatScalar<E, Op>>
+{
+  typedef TMatScalar<typename TExprTranspose<E>::type, Op> type;
+  static type make(const TMatScalar<E, Op>& e)
+  {
+    return type(TExprTranspose<E>::make(e.expr()), e.scalar());
+  }
+};
+template<typename L, typename R>
+struct TExprTranspose<TMatProduct<L, R>>
+{
+  typedef TMatProduct<typename TExprTranspose<R>::type, typename TExprTranspose<L>::type> type;
+  static type make(const TMatProduct<L, R>& e)
+  {
+    return type(TExprTranspose<R>::make(e.right()), TExprTranspose<L>::make(e.left()));
+  }
+};
+
+// Построчная копия транспонированной непрерывной матрицы и матрицы,
+// хранимой по столбцам, - блочное транспонирование
+template<typename T, typename E>
+typename std::enable_if<TIsContiguousOf<E, T>::value>::type
+expr_assign_matrix(T* dst, size_t ld, const TMatTransposed<E>& e)
+{
+  const E& a = e.expr();
+  transpose_strided(a.rows(), a.cols(), a.data(), a.stride(), dst, ld);
+}
+template<typename T, typename A>
+void expr_assign_matrix(T* dst, size_t ld, const TDynamicMatrix<T, A, TColMajor>& m)
+{
+  transpose_strided(m.cols(), m.rows(), m.data(), m.stride(), dst, ld);
+}
+// построчная копия матрицы, хранимой блоками: строки блоков копируются подряд
+template<typename T, typename A, size_t B>
+void expr_assign_matrix(T* dst, size_t ld, const TDynamicMatrix<T, A, TTiled<B>>& m)
+{
+  const size_t rows = m.rows(), cols = m.cols();
+  for (size_t i0 = 0; i0 < rows; i0 += B)
+    for (size_t j0 = 0; j0 < cols; j0 += B)
+    {
+      const T* t = m.data() + TTiled<B>::index(i0, j0, m.stride());
+      const size_t i1 = std::min(i0 + B, rows), nb = std::min(B, cols - j0);
+      for (size_t i = i0; i < i1; i++)
+        std::copy(t + (i - i0) * B, t + (i - i0) * B + nb, dst + i * ld + j0);
+    }
+}
+
+// Вычисление выражения в память матрицы, хранимой по столбцам:
+// транспонированное выражение записывается построчно
+template<typename T, typename E>
+void expr_assign_layout(T* dst, size_t ld, const E& e, TColMajor)
+{
+  expr_assign_matrix(dst, ld, TExprTranspose<E>::make(e));
+}
+// Вычисление выражения в память матрицы, хранимой блоками: блоки
+// заполняются по очереди, строки блока - из строк непрерывного операнда
+template<typename T, typename E, size_t B>
+void expr_assign_tiles(T* dst, size_t ld, const E& e, std::true_type)
+{
+  const size_t m = e.rows(), n = e.cols();
+  for (size_t i0 = 0; i0 < m; i0 += B)
+    for (size_t j0 = 0; j0 < n; j0 += B)
+    {
+      T* t = dst + TTiled<B>::index(i0, j0, ld);
+      const size_t i1 = std::min(i0 + B, m), nb = std::min(B, n - j0);
+      for (size_t i = i0; i < i1; i++)
+      {
+        const T* src = e.data() + i * e.stride() + j0;
+        std::copy(src, src + nb, t + (i - i0) * B);
+      }
+    }
+}
+template<typename T, typename E, size_t B>
+void expr_assign_tiles(T* dst, size_t ld, const E& e, std::false_type)
+{
+  const size_t m = e.rows(), n = e.cols();
+  for (size_t i0 = 0; i0 < m; i0 += B)
+    for (size_t j0 = 0; j0 < n; j0 += B)
+    {
+      T* t = dst + TTiled<B>::index(i0, j0, ld);
+      const size_t i1 = std::min(i0 + B, m), j1 = std::min(j0 + B, n);
+      for (size_t i = i0; i < i1; i++)
+        for (size_t j = j0; j < j1; j++)
+          t[(i - i0) * B + j - j0] = e(i, j);
+    }
+}
+template<typename T, typename E, size_t B>
+void expr_assign_layout(T* dst, size_t ld, const E& e, TTiled<B>)
+{
+  expr_assign_tiles<T, E, B>(dst, ld, e, TIsContiguousOf<E, T>());
+}
+
+
+// Динамическая матрица с порядком хранения Layout (TColMajor, TTiled<B>) -
+// матрица m x n в одном блоке из Layout::storage(m, n, stride()) элементов.
+// Дополнение (хвосты столбцов, неполные блоки) заполнено T() и не входит
+// в матрицу. Матрица, хранимая по столбцам, передаётся в библиотеки
+// Fortran и LAPACK как data() с ведущей размерностью stride().
+// Участвует в выражениях и произведениях вместе с матрицами любого
+// порядка хранения; operator[] возвращает строку-представление TLayoutRow
+template<typename T, typename Alloc, typename Layout>
+class TDynamicMatrix : private TDynamicVector<T, Alloc>
+{
+  using TDynamicVector<T, Alloc>::pMem;
+  typedef typename TDynamicVector<T, Alloc>::TStorageTag TStorageTag;
+  size_t nrows;
+  size_t ncols;
+  size_t ld;
+
+  // ведущая размерность: столбцы выравниваются так же, как строки
+  // матрицы, хранимой по строкам, и так же хранятся без дополнения,
+  // если с ним блок превысил бы MAX_VECTOR_SIZE элементов
+  static size_t lead(size_t m, size_t n) noexcept
+  {
+    const size_t padded = Layout::lead(m, n, TDynamicMatrix<T, Alloc, TRowMajor>::ROW_ALIGN);
+    return Layout::storage(m, n, padded) <= size_t(MAX_VECTOR_SIZE) ? padded : Layout::lead(m, n, 1);
+  }
+  // число элементов блока после проверки размеров m x n; неполные блоки
+  // TTiled<B> не ограничены MAX_VECTOR_SIZE
+  static size_t checked_storage(size_t m, size_t n)
+  {
+    if (m == 0 || n == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    if (m > MAX_MATRIX_ELEMENTS / n)
+      throw out_of_range("Matrix should not have more than MAX_MATRIX_SIZE * MAX_MATRIX_SIZE elements");
+    return Layout::storage(m, n, lead(m, n));
+  }
+  template<typename E>
+  void assign(const E& e)
+  {
+    expr_assign_layout(pMem, stride(), e, Layout());
+  }
+public:
+  typedef TMatExprTag expr_category;
+  typedef T value_type;
+  typedef Layout layout_type;
+
+  // квадратная матрица s x s
+  TDynamicMatrix(size_t s = 1, const Alloc& a = Alloc()) : TDynamicMatrix(s, s, a) {}
+  TDynamicMatrix(size_t s, TUninitializedTag, const Alloc& a = Alloc()) : TDynamicMatrix(s, s, UNINITIALIZED, a) {}
+  // матрица из m строк по n элементов
+  TDynamicMatrix(size_t m, size_t n, const Alloc& a = Alloc())
+    : TDynamicVector<T, Alloc>(TStorageTag(), checked_storage(m, n), true, a), nrows(m), ncols(n), ld(lead(m, n)) {}
+  TDynamicMatrix(size_t m, size_t n, TUninitializedTag, const Alloc& a = Alloc())
+    : TDynamicVector<T, Alloc>(TStorageTag(), checked_storage(m, n), false, a), nrows(m), ncols(n), ld(lead(m, n))
+  {
+    const size_t s = TDynamicVector<T, Alloc>::size();
+    if (s != m * n)
+      std::fill(pMem, pMem + s, T());
+  }
+  TDynamicMatrix(const TDynamicMatrix& m) = default;
+  TDynamicMatrix(TDynamicMatrix&& m) noexcept
+    : TDynamicVector<T, Alloc>(std::move(m)), nrows(m.nrows), ncols(m.ncols), ld(m.ld)
+  {
+    m.nrows = m.ncols = m.ld = 0;
+  }
+  // вычисление матричного выражения с операндами любого порядка хранения
+  template<typename E, typename = typename std::enable_if<TIsMatExpr<E>::value>::type>
+  TDynamicMatrix(const E& e, const Alloc& a = Alloc()) : TDynamicMatrix(e.rows(), e.cols(), UNINITIALIZED, a)
+  {
+    assign(e);
+  }
+  TDynamicMatrix& operator=(const TDynamicMatrix& m) = default;
+  TDynamicMatrix& operator=(TDynamicMatrix&& m)
+    noexcept(std::is_nothrow_move_assignable<TDynamicVector<T, Alloc>>::value)
+  {
+    TDynamicVector<T, Alloc>::operator=(std::move(static_cast<TDynamicVector<T, Alloc>&>(m)));
+    nrows = m.nrows;
+    ncols = m.ncols;
+    ld = m.ld;
+    if (m.data() == nullptr)
+      m.nrows = m.ncols = m.ld = 0;
+    return *this;
+  }
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix&>::type operator=(const E& e)
+  {
+    if (nrows != e.rows() || ncols != e.cols())
+    {
+      TDynamicMatrix tmp(e, get_allocator());
+      swap(*this, tmp);
+      return *this;
+    }
+    assign(e);
+    return *this;
+  }
+
+  // операции с присваиванием выполняются в памяти матрицы
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix&>::type operator+=(const E& e)
+  {
+    assign(TMatBinary<TDynamicMatrix, E, TOpAdd>(*this, e));
+    return *this;
+  }
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix&>::type operator-=(const E& e)
+  {
+    assign(TMatBinary<TDynamicMatrix, E, TOpSub>(*this, e));
+    return *this;
+  }
+  TDynamicMatrix& operator*=(const T& val)
+  {
+    vec_kernels<T>().mul_scalar(pMem, val, pMem, TDynamicVector<T, Alloc>::size());
+    return *this;
+  }
+
+  // порядок квадратной матрицы (число строк)
+  size_t size() const noexcept { return nrows; }
+  size_t rows() const noexcept { return nrows; }
+  size_t cols() const noexcept { return ncols; }
+  // ведущая размерность: элемент (i, j) лежит в data()[Layout::index(i, j, stride())]
+  size_t stride() const noexcept { return ld; }
+  T* data() noexcept { return pMem; }
+  const T* data() const noexcept { return pMem; }
+  using TDynamicVector<T, Alloc>::get_allocator;
+
+  // индексация
+  TLayoutRow<T, Layout> operator[](size_t ind) noexcept
+  {
+    return TLayoutRow<T, Layout>(pMem, ind, stride(), ncols);
+  }
+  TLayoutRow<const T, Layout> operator[](size_t ind) const noexcept
+  {
+    return TLayoutRow<const T, Layout>(pMem, ind, stride(), ncols);
+  }
+  // индексация с контролем
+  TLayoutRow<T, Layout> at(size_t ind)
+  {
+    if (ind >= nrows)
+      throw out_of_range("Matrix index is out of range");
+    return (*this)[ind];
+  }
+  TLayoutRow<const T, Layout> at(size_t ind) const
+  {
+    if (ind >= nrows)
+      throw out_of_range("Matrix index is out of range");
+    return (*this)[ind];
+  }
+  // элемент (i, j)
+  T& operator()(size_t i, size_t j) noexcept
+  {
+    return pMem[Layout::index(i, j, stride())];
+  }
+  const T& operator()(size_t i, size_t j) const noexcept
+  {
+    return pMem[Layout::index(i, j, stride())];
+  }
+
+  // сравнение
+  friend bool operator==(const TDynamicMatrix& a, const TDynamicMatrix& b) noexcept
+  {
+    if (a.nrows != b.nrows || a.ncols != b.ncols)
+      return false;
+    for (size_t i = 0; i < a.nrows; i++)
+      for (size_t j = 0; j < a.ncols; j++)
+        if (!(a(i, j) == b(i, j)))
+          return false;
+    return true;
+  }
+  friend bool operator!=(const TDynamicMatrix& a, const TDynamicMatrix& b) noexcept
+  {
+    return !(a == b);
+  }
+
+  friend void swap(TDynamicMatrix& lhs, TDynamicMatrix& rhs) noexcept
+  {
+    swap(static_cast<TDynamicVector<T, Alloc>&>(lhs), static_cast<TDynamicVector<T, Alloc>&>(rhs));
+    std::swap(lhs.nrows, rhs.nrows);
+    std::swap(lhs.ncols, rhs.ncols);
+    std::swap(lhs.ld, rhs.ld);
+  }
+
+  // ввод/вывод: m строк по n элементов, как у матрицы, хранимой по строкам
+  friend istream& operator>>(istream& istr, TDynamicMatrix& v)
+  {
+    for (size_t i = 0; i < v.nrows; i++)
+      for (size_t j = 0; j < v.ncols; j++)
+        istr >> v(i, j);
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
+  {
+    for (size_t i = 0; i < v.nrows; i++)
+    {
+      for (size_t j = 0; j < v.ncols; j++)
+        ostr << v(i, j) << ' ';
+      ostr << endl;
+    }
+    return ostr;
+  }
+};
+
+// матрицы, хранимые по столбцам и блоками
+template<typename T, typename Alloc = TAlignedAllocator<T>>
+using TColMajorMatrix = TDynamicMatrix<T, Alloc, TColMajor>;
+template<typename T, size_t B = 32, typename Alloc = TAlignedAllocator<T>>
+using TTiledMatrix = TDynamicMatrix<T, Alloc, TTiled<B>>;
+
+template<typename T, typename A, typename L>
+struct TExprStore<TDynamicMatrix<T, A, L>>
+{
+  typedef const TDynamicMatrix<T, A, L>& type;
+};
+
+// Признак матрицы, хранимой не по строкам
+template<typename E>
+struct TIsLayoutMatrix : std::false_type {};
+template<typename T, typename A, typename L>
+struct TIsLayoutMatrix<TDynamicMatrix<T, A, L>> : std::integral_constant<bool, !std::is_same<L, TRowMajor>::value> {};
+
+// Матрица, хранимая по столбцам, на вектор: y = sum(x[j] * столбец j),
+// столбцы проходятся подряд
+template<typename T, typename A, typename EV>
+typename std::enable_if<TIsExprOf<EV, T, TVecExprTag>::value, TDynamicVector<T>>::type
+operator*(const TDynamicMatrix<T, A, TColMajor>& m, const EV& ev)
+{
+  const auto& v = materialize(ev);
+  if (m.cols() != v.size())
+    throw length_error("Matrix and vector sizes do not match");
+  TDynamicVector<T> res(m.rows());
+  const TVecKernels<T>& k = vec_kernels<T>();
+  for (size_t j = 0; j < m.cols(); j++)
+    k.axpy(v[j], m.data() + j * m.stride(), res.data(), m.rows());
+  return res;
+}
+
+// Матрица, хранимая блоками, на вектор: каждый блок B x B умножается
+// на свой отрезок x там, где лежит, без перестановки матрицы по строкам
+template<typename T, typename A, size_t B, typename EV>
+typename std::enable_if<TIsExprOf<EV, T, TVecExprTag>::value, TDynamicVector<T>>::type
+operator*(const TDynamicMatrix<T, A, TTiled<B>>& m, const EV& ev)
+{
+  const auto& v = materialize(ev);
+  if (m.cols() != v.size())
+    throw length_error("Matrix and vector sizes do not match");
+  if (expr_inc(v) != 1)
+    return m * TDynamicVector<T>(v);
+  TDynamicVector<T> res(m.rows());
+  const TVecKernels<T>& k = vec_kernels<T>();
+  for (size_t i0 = 0; i0 < m.rows(); i0 += B)
+    for (size_t j0 = 0; j0 < m.cols(); j0 += B)
+    {
+      const size_t i1 = std::min(i0 + B, m.rows()), nb = std::min(B, m.cols() - j0);
+      const T* t = m.data() + TTiled<B>::index(i0, j0, m.stride());
+      for (size_t i = i0; i < i1; i++)
+        res[i] += k.dot(t + (i - i0) * B, v.data() + j0, nb);
+    }
+  return res;
+}
+
+// сравнение матриц разного порядка хранения (с представлениями - в tview.h)
+template<typename L, typename R>
+typename std::enable_if<TIsMatExpr<L>::value && TIsMatExpr<R>::value &&
+  (TIsLayoutMatrix<L>::value || TIsLayoutMatrix<R>::value) && !TIsView<L>::value && !TIsView<R>::value, bool>::type
+operator==(const L& l, const R& r)
+{
+  if (l.rows() != r.rows() || l.cols() != r.cols())
+    return false;
+  for (size_t i0 = 0; i0 < l.rows(); i0 += TRANSPOSE_BLOCK)
+    for (size_t j0 = 0; j0 < l.cols(); j0 += TRANSPOSE_BLOCK)
+    {
+      const size_t i1 = std::min(i0 + TRANSPOSE_BLOCK, l.rows()), j1 = std::min(j0 + TRANSPOSE_BLOCK, l.cols());
+      for (size_t i = i0; i < i1; i++)
+        for (size_t j = j0; j < j1; j++)
+          if (!(l(i, j) == r(i, j)))
+            return false;
+    }
+  return true;
+}
+template<typename L, typename R>
+typename std::enable_if<TIsMatExpr<L>::value && TIsMatExpr<R>::value &&
+  (TIsLayoutMatrix<L>::value || TIsLayoutMatrix<R>::value) && !TIsView<L>::value && !TIsView<R>::value, bool>::type
+operator!=(const L& l, const R& r)
+{
+  return !(l == r);
+}
+
+#endif
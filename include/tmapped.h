@@ -0,0 +1,281 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Матрица, отображённая из двоичного файла.
+// Открытие файла не читает элементы: система подгружает страницы при
+// обращении, а открытые только для чтения файлы разделяются процессами
+// через общий страничный кэш без копирования
+
+#ifndef __TMappedMatrix_H__
+#define __TMappedMatrix_H__
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include "tmatrix.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TMATRIX_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Формат файла: заголовок TMappedHeader размером 64 байта, затем строки
+// матрицы с шагом stride элементов (как в TDynamicMatrix). Данные
+// начинаются на границе строки кэша
+struct TMappedHeader
+{
+  char magic[8];       // "TMATRIX"
+  uint32_t version;
+  uint32_t elem_size;  // sizeof(T)
+  uint64_t rows;
+  uint64_t cols;
+  uint64_t stride;
+  char reserved[24];
+};
+static_assert(sizeof(TMappedHeader) == 64, "Matrix file header should take 64 bytes");
+
+// Режим доступа к файлу
+enum TMappedAccess
+{
+  MAPPED_READ,       // только чтение, отображение разделяется процессами
+  MAPPED_READ_WRITE  // изменения записываются в файл
+};
+
+// Отображение файла в память
+class TMappedFile
+{
+  void* base;
+  size_t len;
+
+  static void fail(const std::string& what, const std::string& path)
+  {
+    throw std::runtime_error(what + ": " + path);
+  }
+public:
+  TMappedFile() noexcept : base(nullptr), len(0) {}
+  // отображение файла целиком; при size > 0 файл создаётся размером size байт
+  TMappedFile(const std::string& path, TMappedAccess access, size_t size = 0) : base(nullptr), len(0)
+  {
+#ifdef TMATRIX_HAS_MMAP
+    const bool write = access == MAPPED_READ_WRITE;
+    const int fd = size > 0 ? ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) :
+      ::open(path.c_str(), write ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+      fail("Cannot open file", path);
+    struct stat st;
+    if (size > 0 ? ::ftruncate(fd, off_t(size)) != 0 : ::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      fail("Cannot size file", path);
+    }
+    len = size > 0 ? size : size_t(st.st_size);
+    if (len == 0)
+    {
+      ::close(fd);
+      fail("File is empty", path);
+    }
+    void* m = ::mmap(nullptr, len, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED)
+      fail("Cannot map file", path);
+    base = m;
+#else
+    (void)access;
+    (void)size;
+    fail("Memory-mapped files are not supported on this platform", path);
+#endif
+  }
+  TMappedFile(const TMappedFile&) = delete;
+  TMappedFile(TMappedFile&& f) noexcept : base(f.base), len(f.len)
+  {
+    f.base = nullptr;
+    f.len = 0;
+  }
+  TMappedFile& operator=(const TMappedFile&) = delete;
+  TMappedFile& operator=(TMappedFile&& f) noexcept
+  {
+    std::swap(base, f.base);
+    std::swap(len, f.len);
+    return *this;
+  }
+  ~TMappedFile()
+  {
+#ifdef TMATRIX_HAS_MMAP
+    if (base != nullptr)
+      ::munmap(base, len);
+#endif
+  }
+
+  char* data() const noexcept { return static_cast<char*>(base); }
+  size_t size() const noexcept { return len; }
+
+  // запись изменённых страниц в файл
+  void flush() const
+  {
+#ifdef TMATRIX_HAS_MMAP
+    if (base != nullptr && ::msync(base, len, MS_SYNC) != 0)
+      throw std::runtime_error("Cannot flush mapped file");
+#endif
+  }
+};
+
+// Матрица в файле -
+// матрица m x n, элементы которой лежат в отображённом файле.
+// Участвует в выражениях, произведениях и gemv наравне с TDynamicMatrix.
+// Режим доступа задаётся типом: TMappedMatrix<T> открывает файл в режиме
+// MAPPED_READ_WRITE, TMappedMatrix<const T> - в режиме MAPPED_READ, и его
+// data() и operator[] возвращают константные элементы.
+// Размер матрицы ограничен только размером файла, но вычисление выражений
+// и произведений во временные TDynamicMatrix подчиняется MAX_MATRIX_SIZE
+template<typename T>
+class TMappedMatrix
+{
+public:
+  typedef TMatExprTag expr_category;
+  typedef typename std::remove_const<T>::type value_type;
+private:
+  static_assert(std::is_trivial<value_type>::value, "Mapped matrix elements should be of trivial type");
+  static const uint32_t VERSION = 1;
+
+  TMappedFile file;
+  size_t nrows;
+  size_t ncols;
+  size_t st;
+  T* pMem;
+
+  static void init_header(TMappedHeader& h, size_t m, size_t n)
+  {
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, "TMATRIX", 8);
+    h.version = VERSION;
+    h.elem_size = sizeof(T);
+    h.rows = m;
+    h.cols = n;
+    const size_t a = TDynamicMatrix<value_type>::ROW_ALIGN;
+    h.stride = (n + a - 1) / a * a;
+  }
+  void attach(const std::string& path)
+  {
+    if (file.size() < sizeof(TMappedHeader))
+      throw std::runtime_error("File is too short for a matrix header: " + path);
+    TMappedHeader h;
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, "TMATRIX", 8) != 0 || h.version != VERSION)
+      throw std::runtime_error("File is not a matrix file: " + path);
+    if (h.elem_size != sizeof(T))
+      throw std::runtime_error("Matrix file element size does not match: " + path);
+    // отображение не выделяет память в куче: размер ограничен только файлом
+    if (h.rows == 0 || h.cols == 0 || h.stride < h.cols)
+      throw std::runtime_error("Matrix file has unsupported shape: " + path);
+    if ((file.size() - sizeof(TMappedHeader)) / sizeof(T) / h.stride < h.rows)
+      throw std::runtime_error("Matrix file is truncated: " + path);
+    nrows = size_t(h.rows);
+    ncols = size_t(h.cols);
+    st = size_t(h.stride);
+    pMem = reinterpret_cast<T*>(file.data() + sizeof(TMappedHeader));
+  }
+  TMappedMatrix(TMappedFile&& f, const std::string& path) : file(std::move(f))
+  {
+    attach(path);
+  }
+public:
+  // открытие файла матрицы без чтения элементов
+  explicit TMappedMatrix(const std::string& path) : TMappedMatrix(TMappedFile(path, access()), path) {}
+  TMappedMatrix(TMappedMatrix&& m) noexcept = default;
+  TMappedMatrix& operator=(TMappedMatrix&& m) noexcept = default;
+
+  // новый файл матрицы m x n, элементы равны T() (нулевые байты)
+  static TMappedMatrix create(const std::string& path, size_t m, size_t n)
+  {
+    static_assert(!std::is_const<T>::value, "Read-only mapped matrix cannot create a file");
+    if (m == 0 || n == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    TMappedHeader h;
+    init_header(h, m, n);
+    if (h.stride < n || m > (SIZE_MAX - sizeof(TMappedHeader)) / sizeof(T) / h.stride)
+      throw out_of_range("Matrix file size should fit in the address space");
+    TMappedFile f(path, MAPPED_READ_WRITE, sizeof(TMappedHeader) + size_t(h.rows * h.stride) * sizeof(T));
+    std::memcpy(f.data(), &h, sizeof(h));
+    return TMappedMatrix(std::move(f), path);
+  }
+  static TMappedMatrix create(const std::string& path, size_t n)
+  {
+    return create(path, n, n);
+  }
+  // запись матричного выражения в новый файл
+  template<typename E>
+  static typename std::enable_if<TIsExprOf<E, value_type, TMatExprTag>::value>::type
+  save(const std::string& path, const E& e)
+  {
+    TMappedMatrix<value_type> m = TMappedMatrix<value_type>::create(path, e.rows(), e.cols());
+    expr_assign_matrix(m.data(), m.stride(), e);
+    m.flush();
+  }
+
+  // матрице только для чтения присваивать нельзя
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value && !std::is_const<T>::value, TMappedMatrix&>::type
+  operator=(const E& e)
+  {
+    if (nrows != e.rows() || ncols != e.cols())
+      throw length_error("Matrices should have equal size");
+    expr_assign_matrix(pMem, st, e);
+    return *this;
+  }
+
+  size_t size() const noexcept { return nrows; }
+  size_t rows() const noexcept { return nrows; }
+  size_t cols() const noexcept { return ncols; }
+  size_t stride() const noexcept { return st; }
+  static TMappedAccess access() noexcept { return std::is_const<T>::value ? MAPPED_READ : MAPPED_READ_WRITE; }
+  T* data() noexcept { return pMem; }
+  const value_type* data() const noexcept { return pMem; }
+  void flush() const { file.flush(); }
+
+  // индексация
+  TMatrixRow<T> operator[](size_t ind) noexcept
+  {
+    return TMatrixRow<T>(pMem + ind * st, ncols);
+  }
+  TMatrixRow<const value_type> operator[](size_t ind) const noexcept
+  {
+    return TMatrixRow<const value_type>(pMem + ind * st, ncols);
+  }
+  // индексация с контролем
+  TMatrixRow<const value_type> at(size_t ind) const
+  {
+    if (ind >= nrows)
+      throw out_of_range("Matrix index is out of range");
+    return (*this)[ind];
+  }
+  // элемент для вычисления выражений
+  const value_type& operator()(size_t i, size_t j) const noexcept
+  {
+    return pMem[i * st + j];
+  }
+};
+
+template<typename T>
+const uint32_t TMappedMatrix<T>::VERSION;
+
+template<typename T>
+struct TExprStore<TMappedMatrix<T>>
+{
+  typedef const TMappedMatrix<T>& type;
+};
+template<typename T>
+struct TIsContiguous<TMappedMatrix<T>> : std::true_type {};
+
+// операнд произведения используется без копирования
+template<typename T>
+const TMappedMatrix<T>& materialize(const TMappedMatrix<T>& m) noexcept
+{
+  return m;
+}
+
+#endif
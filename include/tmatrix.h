@@ -8,101 +8,316 @@
 #define __TDynamicMatrix_H__
 
 #include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <type_traits>
+#include <memory>
+#include <functional>
+#include "talloc.h"
+#include "tsimd.h"
+#include "tgemm.h"
+#include "texpr.h"
 
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
+// матрица m x n содержит не больше MAX_MATRIX_SIZE * MAX_MATRIX_SIZE элементов
+const size_t MAX_MATRIX_ELEMENTS = size_t(MAX_MATRIX_SIZE) * MAX_MATRIX_SIZE;
 
-// Динамический вектор - 
-// шаблонный вектор на динамической памяти
-template<typename T>
+// Размер встроенного буфера вектора в байтах (0 - буфер не используется)
+#ifndef TMATRIX_SBO_SIZE
+#define TMATRIX_SBO_SIZE 64
+#endif
+
+// Тег создания без инициализации: элементы простых типов не обнуляются
+// и должны быть записаны до чтения. Используется для результатов,
+// которые заполняются целиком
+struct TUninitializedTag {};
+const TUninitializedTag UNINITIALIZED = TUninitializedTag();
+
+// Динамический вектор -
+// шаблонный вектор на динамической памяти.
+// Память выделяется распределителем Alloc (по умолчанию - TAlignedAllocator<T>
+// из talloc.h с выравниванием на TMATRIX_ALIGNMENT байт). Короткие векторы простых типов
+// (до TMATRIX_SBO_SIZE байт) хранятся во встроенном буфере с выравниванием
+// alignof(T) и не обращаются к распределителю
+template<typename T, typename Alloc = TAlignedAllocator<T>>
 class TDynamicVector
 {
+  static_assert(std::is_same<typename Alloc::value_type, T>::value, "Alloc::value_type should be T");
+  typedef std::allocator_traits<Alloc> TAllocTraits;
+
+  // число элементов во встроенном буфере
+  static const size_t SBO_CAP = std::is_trivial<T>::value ? TMATRIX_SBO_SIZE / sizeof(T) : 0;
+  typename std::aligned_storage<SBO_CAP ? SBO_CAP * sizeof(T) : 1, alignof(T)>::type buf;
+  Alloc alloc;
+
+  T* local() noexcept { return reinterpret_cast<T*>(&buf); }
+  bool is_local() const noexcept { return pMem == reinterpret_cast<const T*>(&buf); }
+  // память под n элементов: встроенный буфер или распределитель.
+  // Элементы простых типов без zero не инициализируются, как в new T[n]
+  T* allocate(size_t n, bool zero)
+  {
+    if (n <= SBO_CAP)
+    {
+      if (zero)
+        std::fill(local(), local() + n, T());
+      return local();
+    }
+    T* p = TAllocTraits::allocate(alloc, n);
+    if (!zero && std::is_trivial<T>::value)
+      return p;
+    size_t i = 0;
+    try
+    {
+      for (; i < n; i++)
+        TAllocTraits::construct(alloc, p + i);
+    }
+    catch (...)
+    {
+      while (i > 0)
+        TAllocTraits::destroy(alloc, p + --i);
+      TAllocTraits::deallocate(alloc, p, n);
+      throw;
+    }
+    return p;
+  }
+  void release() noexcept
+  {
+    if (is_local() || pMem == nullptr)
+      return;
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t i = 0; i < sz; i++)
+        TAllocTraits::destroy(alloc, pMem + i);
+    TAllocTraits::deallocate(alloc, pMem, sz);
+  }
+  static size_t checked_size(size_t s)
+  {
+    if (s == 0)
+      throw out_of_range("Vector size should be greater than zero");
+    if (s > MAX_VECTOR_SIZE)
+      throw out_of_range("Vector size should not exceed MAX_VECTOR_SIZE");
+    return s;
+  }
+  // v переходит в *this, v остаётся пустым
+  void take(TDynamicVector& v) noexcept
+  {
+    sz = v.sz;
+    if (v.is_local())
+    {
+      pMem = local();
+      std::copy(v.pMem, v.pMem + sz, pMem);
+    }
+    else
+      pMem = v.pMem;
+    v.sz = 0;
+    v.pMem = nullptr;
+  }
 protected:
   size_t sz;
   T* pMem;
+
+  // Блок хранения матрицы: размеры проверяет сама матрица, а неполные
+  // блоки матрицы, хранимой блоками, могут выводить его за MAX_VECTOR_SIZE
+  struct TStorageTag {};
+  TDynamicVector(TStorageTag, size_t size, bool zero, const Alloc& a) : alloc(a), sz(size)
+  {
+    pMem = allocate(sz, zero);
+  }
 public:
-  TDynamicVector(size_t size = 1) : sz(size)
+  typedef TVecExprTag expr_category;
+  typedef T value_type;
+
+  TDynamicVector(size_t size = 1, const Alloc& a = Alloc()) : alloc(a), sz(checked_size(size))
   {
-    if (sz == 0)
-      throw out_of_range("Vector size should be greater than zero");
-    pMem = new T[sz]();// {}; // У типа T д.б. конструктор по умолчанию
+    pMem = allocate(sz, true); // У типа T д.б. конструктор по умолчанию
   }
-  TDynamicVector(T* arr, size_t s) : sz(s)
+  TDynamicVector(size_t size, TUninitializedTag, const Alloc& a = Alloc()) : alloc(a), sz(checked_size(size))
+  {
+    pMem = allocate(sz, false);
+  }
+  TDynamicVector(T* arr, size_t s, const Alloc& a = Alloc()) : alloc(a), sz(s)
   {
     assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-    pMem = new T[sz];
+    pMem = allocate(sz, false);
     std::copy(arr, arr + sz, pMem);
   }
   TDynamicVector(const TDynamicVector& v)
+    : alloc(TAllocTraits::select_on_container_copy_construction(v.alloc)), sz(v.sz)
+  {
+    pMem = allocate(sz, false);
+    std::copy(v.pMem, v.pMem + sz, pMem);
+  }
+  TDynamicVector(TDynamicVector&& v) noexcept : alloc(std::move(v.alloc))
   {
+    take(v);
   }
-  TDynamicVector(TDynamicVector&& v) noexcept
+  // вычисление векторного выражения одним проходом
+  template<typename E, typename = typename std::enable_if<TIsVecExpr<E>::value>::type>
+  TDynamicVector(const E& e, const Alloc& a = Alloc()) : TDynamicVector(e.size(), UNINITIALIZED, a)
   {
+    expr_assign(pMem, e);
   }
   ~TDynamicVector()
   {
+    release();
   }
   TDynamicVector& operator=(const TDynamicVector& v)
   {
+    if (this == &v)
+      return *this;
+    if (TAllocTraits::propagate_on_container_copy_assignment::value && !(alloc == v.alloc))
+    {
+      // память освобождается прежним распределителем
+      release();
+      pMem = nullptr;
+      sz = 0;
+      alloc = v.alloc;
+    }
+    if (sz != v.sz)
+    {
+      T* p = allocate(v.sz, false);
+      release();
+      pMem = p;
+      sz = v.sz;
+    }
+    std::copy(v.pMem, v.pMem + sz, pMem);
+    return *this;
   }
-  TDynamicVector& operator=(TDynamicVector&& v) noexcept
+  // память v забирается, если её можно освободить нашим распределителем,
+  // иначе элементы копируются
+  TDynamicVector& operator=(TDynamicVector&& v) noexcept(TAllocTraits::propagate_on_container_move_assignment::value)
   {
-      return (*this); // заглушка
+    if (this == &v)
+      return *this;
+    if (!TAllocTraits::propagate_on_container_move_assignment::value && !(alloc == v.alloc))
+      return *this = static_cast<const TDynamicVector&>(v);
+    release();
+    if (TAllocTraits::propagate_on_container_move_assignment::value)
+      alloc = std::move(v.alloc);
+    take(v);
+    return *this;
   }
-
-  size_t size() const noexcept { return sz; }
-
-  // индексация
-  T& operator[](size_t ind)
+  // поэлементные выражения могут ссылаться на *this: элемент i
+  // вычисляется только из элементов i операндов
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TDynamicVector&>::type operator=(const E& e)
   {
+    if (sz != e.size())
+    {
+      TDynamicVector tmp(e, alloc);
+      swap(*this, tmp);
+      return *this;
+    }
+    expr_assign(pMem, e);
+    return *this;
   }
-  const T& operator[](size_t ind) const
+
+  // операции с присваиванием выполняются в памяти вектора
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TDynamicVector&>::type operator+=(const E& e)
   {
+    expr_assign(pMem, TVecBinary<TDynamicVector, E, TOpAdd>(*this, e));
+    return *this;
   }
-  // индексация с контролем
-  T& at(size_t ind)
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TDynamicVector&>::type operator-=(const E& e)
   {
+    expr_assign(pMem, TVecBinary<TDynamicVector, E, TOpSub>(*this, e));
+    return *this;
   }
-  const T& at(size_t ind) const
+  TDynamicVector& operator+=(T val)
   {
+    expr_assign(pMem, TVecScalar<TDynamicVector, TOpAdd>(*this, val));
+    return *this;
   }
-
-  // сравнение
-  bool operator==(const TDynamicVector& v) const noexcept
+  TDynamicVector& operator-=(T val)
   {
+    expr_assign(pMem, TVecScalar<TDynamicVector, TOpSub>(*this, val));
+    return *this;
   }
-  bool operator!=(const TDynamicVector& v) const noexcept
+  TDynamicVector& operator*=(T val)
   {
+    scal(val, *this);
+    return *this;
   }
 
-  // скалярные операции
-  TDynamicVector operator+(T val)
+  size_t size() const noexcept { return sz; }
+  T* data() noexcept { return pMem; }
+  const T* data() const noexcept { return pMem; }
+  Alloc get_allocator() const { return alloc; }
+
+  // индексация
+  T& operator[](size_t ind)
   {
+    return pMem[ind];
   }
-  TDynamicVector operator-(T val)
+  const T& operator[](size_t ind) const
   {
+    return pMem[ind];
   }
-  TDynamicVector operator*(T val)
+  // индексация с контролем
+  T& at(size_t ind)
   {
+    if (ind >= sz)
+      throw out_of_range("Vector index is out of range");
+    return pMem[ind];
   }
-
-  // векторные операции
-  TDynamicVector operator+(const TDynamicVector& v)
+  const T& at(size_t ind) const
   {
+    if (ind >= sz)
+      throw out_of_range("Vector index is out of range");
+    return pMem[ind];
   }
-  TDynamicVector operator-(const TDynamicVector& v)
+
+  // сравнение
+  friend bool operator==(const TDynamicVector& a, const TDynamicVector& b) noexcept
   {
+    return a.sz == b.sz && std::equal(a.pMem, a.pMem + a.sz, b.pMem);
   }
-  T operator*(const TDynamicVector& v) noexcept(noexcept(T()))
+  friend bool operator!=(const TDynamicVector& a, const TDynamicVector& b) noexcept
   {
+    return !(a == b);
   }
 
+  // скалярные и векторные операции (+, -, *) возвращают ленивые
+  // выражения и определены для всех векторных выражений в texpr.h
+
+  // указатели на память распределителя обмениваются, встроенные буферы
+  // копируются. Распределители обмениваются, если это разрешено их типом,
+  // иначе они должны быть равны (как у стандартных контейнеров)
   friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
   {
-    std::swap(lhs.sz, rhs.sz);
-    std::swap(lhs.pMem, rhs.pMem);
+    if (&lhs == &rhs)
+      return;
+    if (TAllocTraits::propagate_on_container_swap::value)
+    {
+      using std::swap;
+      swap(lhs.alloc, rhs.alloc);
+    }
+    if (!lhs.is_local() && !rhs.is_local())
+    {
+      std::swap(lhs.sz, rhs.sz);
+      std::swap(lhs.pMem, rhs.pMem);
+      return;
+    }
+    decltype(lhs.buf) tmp;
+    const size_t lsz = lhs.sz;
+    T* lmem = lhs.pMem;
+    const bool llocal = lhs.is_local();
+    if (llocal)
+      std::copy(lmem, lmem + lsz, reinterpret_cast<T*>(&tmp));
+    lhs.take(rhs);
+    rhs.sz = lsz;
+    if (llocal)
+    {
+      rhs.pMem = rhs.local();
+      std::copy(reinterpret_cast<T*>(&tmp), reinterpret_cast<T*>(&tmp) + lsz, rhs.pMem);
+    }
+    else
+      rhs.pMem = lmem;
   }
 
   // ввод/вывод
@@ -121,55 +336,787 @@ public:
 };
 
 
-// Динамическая матрица - 
-// шаблонная матрица на динамической памяти
+template<typename T, typename Alloc>
+const size_t TDynamicVector<T, Alloc>::SBO_CAP;
+
+template<typename T, typename Alloc>
+struct TExprStore<TDynamicVector<T, Alloc>>
+{
+  typedef const TDynamicVector<T, Alloc>& type;
+};
+template<typename T, typename Alloc>
+struct TIsContiguous<TDynamicVector<T, Alloc>> : std::true_type {};
+
+// Режим вычисления скалярного произведения
+enum TDotMode
+{
+  DOT_FAST,        // несколько аккумуляторов и попарное сложение блоков
+  DOT_COMPENSATED  // суммирование с компенсацией (Кэхэн/Ноймайер)
+};
+
+// Пересекаются ли области памяти [p, p + m) и [q, q + k)
+template<typename T>
+bool mem_overlap(const T* p, size_t m, const T* q, size_t k) noexcept
+{
+  return std::less<const T*>()(p, q + k) && std::less<const T*>()(q, p + m);
+}
+
+// Скалярное произведение с выбором режима для векторов и представлений.
+// Операнд с шагом, отличным от 1, копируется во временный вектор
+template<typename X, typename Y>
+typename std::enable_if<TIsVecExpr<X>::value && TIsDirectOf<X, typename X::value_type>::value &&
+  TIsDirectOf<Y, typename X::value_type>::value, typename X::value_type>::type
+dot(const X& a, const Y& b, TDotMode mode = DOT_FAST)
+{
+  typedef typename X::value_type T;
+  if (a.size() != b.size())
+    throw length_error("Vectors should have equal size");
+  if (expr_inc(a) != 1)
+    return dot(TDynamicVector<T>(a), b, mode);
+  if (expr_inc(b) != 1)
+    return dot(a, TDynamicVector<T>(b), mode);
+  const TVecKernels<T>& k = vec_kernels<T>();
+  return mode == DOT_COMPENSATED ? k.dot_compensated(a.data(), b.data(), a.size()) :
+    k.dot(a.data(), b.data(), a.size());
+}
+
+
+// Операции над временными векторами вычисляются в памяти временного
+// операнда и возвращают его, не выделяя новый вектор
+template<typename T, typename A>
+TDynamicVector<T, A> operator+(TDynamicVector<T, A>&& v, typename TDynamicVector<T, A>::value_type val)
+{
+  v += val;
+  return std::move(v);
+}
+template<typename T, typename A>
+TDynamicVector<T, A> operator-(TDynamicVector<T, A>&& v, typename TDynamicVector<T, A>::value_type val)
+{
+  v -= val;
+  return std::move(v);
+}
+template<typename T, typename A>
+TDynamicVector<T, A> operator*(TDynamicVector<T, A>&& v, typename TDynamicVector<T, A>::value_type val)
+{
+  v *= val;
+  return std::move(v);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TVecExprTag>::value, TDynamicVector<T, A>>::type
+operator+(TDynamicVector<T, A>&& l, const E& r)
+{
+  l += r;
+  return std::move(l);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TVecExprTag>::value, TDynamicVector<T, A>>::type
+operator+(const E& l, TDynamicVector<T, A>&& r)
+{
+  r += l;
+  return std::move(r);
+}
+template<typename T, typename A>
+TDynamicVector<T, A> operator+(TDynamicVector<T, A>&& l, TDynamicVector<T, A>&& r)
+{
+  l += r;
+  return std::move(l);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TVecExprTag>::value, TDynamicVector<T, A>>::type
+operator-(TDynamicVector<T, A>&& l, const E& r)
+{
+  l -= r;
+  return std::move(l);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TVecExprTag>::value, TDynamicVector<T, A>>::type
+operator-(const E& l, TDynamicVector<T, A>&& r)
+{
+  expr_assign(r.data(), TVecBinary<E, TDynamicVector<T, A>, TOpSub>(l, r));
+  return std::move(r);
+}
+template<typename T, typename A>
+TDynamicVector<T, A> operator-(TDynamicVector<T, A>&& l, TDynamicVector<T, A>&& r)
+{
+  l -= r;
+  return std::move(l);
+}
+
+template<typename T> class TVectorView;
+template<typename T> class TMatrixView;
+// порядок хранения Layout задаёт TRowMajor, TColMajor или TTiled (texpr.h),
+// матрицы с порядком, отличным от построчного, описаны в tlayout.h
+template<typename T, typename Alloc = TAlignedAllocator<T>, typename Layout = TRowMajor>
+class TDynamicMatrix;
+
+// Строка матрицы -
+// легковесное представление строки, не владеющее памятью
 template<typename T>
-class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
+class TMatrixRow
 {
-  using TDynamicVector<TDynamicVector<T>>::pMem;
-  using TDynamicVector<TDynamicVector<T>>::sz;
+  T* pRow;
+  size_t sz;
 public:
-  TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
+  typedef TVecExprTag expr_category;
+  typedef typename std::remove_const<T>::type value_type;
+
+  TMatrixRow(T* p, size_t size) noexcept : pRow(p), sz(size) {}
+  TMatrixRow(const TMatrixRow& r) = default;
+
+  // присваивание копирует элементы, а не перенаправляет представление
+  TMatrixRow& operator=(const TMatrixRow& r)
+  {
+    if (sz != r.sz)
+      throw length_error("Rows should have equal size");
+    std::copy(r.pRow, r.pRow + sz, pRow);
+    return *this;
+  }
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TMatrixRow&>::type operator=(const E& e)
   {
-    for (size_t i = 0; i < sz; i++)
-      pMem[i] = TDynamicVector<T>(sz);
+    if (sz != e.size())
+      throw length_error("Row and vector should have equal size");
+    expr_assign(pRow, e);
+    return *this;
   }
 
-  using TDynamicVector<TDynamicVector<T>>::operator[];
+  size_t size() const noexcept { return sz; }
+  T* data() const noexcept { return pRow; }
 
-  // сравнение
-  bool operator==(const TDynamicMatrix& m) const noexcept
+  // индексация
+  T& operator[](size_t ind) const
+  {
+    return pRow[ind];
+  }
+  // индексация с контролем
+  T& at(size_t ind) const
   {
+    if (ind >= sz)
+      throw out_of_range("Row index is out of range");
+    return pRow[ind];
   }
+};
+
+template<typename T>
+struct TIsContiguous<TMatrixRow<T>> : std::true_type {};
 
-  // матрично-скалярные операции
-  TDynamicMatrix operator*(const T& val)
+
+// Динамическая матрица -
+// шаблонная матрица m x n на динамической памяти.
+// Элементы хранятся построчно в одном непрерывном блоке, строка занимает
+// stride() элементов: у простых типов длина строки дополняется до кратной
+// TMATRIX_ALIGNMENT байт, и при выровненном блоке каждая строка начинается
+// на границе строки кэша. Дополнение не увеличивает блок сверх
+// MAX_VECTOR_SIZE элементов: у таких матриц строки хранятся без него.
+// Дополнение строк заполнено T() и не входит в матрицу. operator[]
+// возвращает представление строки без копирования.
+// Блок выделяется распределителем Alloc
+template<typename T, typename Alloc>
+class TDynamicMatrix<T, Alloc, TRowMajor> : private TDynamicVector<T, Alloc>
+{
+  using TDynamicVector<T, Alloc>::pMem;
+  size_t nrows;
+  size_t ncols;
+  size_t ld;
+
+  // число элементов блока с дополнением после проверки размеров m x n;
+  // дополнение не выводит блок за MAX_VECTOR_SIZE (см. row_stride)
+  static size_t checked_storage(size_t m, size_t n)
   {
+    if (m == 0 || n == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    if (m > MAX_MATRIX_ELEMENTS / n)
+      throw out_of_range("Matrix should not have more than MAX_MATRIX_SIZE * MAX_MATRIX_SIZE elements");
+    return m * row_stride(m, n);
   }
+  // шаг строк: длина строки с дополнением, а если дополненный блок
+  // превысил бы MAX_VECTOR_SIZE элементов - длина строки без дополнения
+  static size_t row_stride(size_t m, size_t n) noexcept
+  {
+    const size_t p = (n + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+    return m <= MAX_VECTOR_SIZE / p ? p : n;
+  }
+public:
+  typedef TMatExprTag expr_category;
+  typedef T value_type;
 
-  // матрично-векторные операции
-  TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+  // шаг строк кратен ROW_ALIGN элементам
+  static const size_t ROW_ALIGN = std::is_trivial<T>::value && TMATRIX_ALIGNMENT % sizeof(T) == 0 ?
+    TMATRIX_ALIGNMENT / sizeof(T) : 1;
+
+  // квадратная матрица s x s
+  TDynamicMatrix(size_t s = 1, const Alloc& a = Alloc()) : TDynamicMatrix(s, s, a) {}
+  TDynamicMatrix(size_t s, TUninitializedTag, const Alloc& a = Alloc()) : TDynamicMatrix(s, s, UNINITIALIZED, a) {}
+  // матрица из m строк по n элементов
+  TDynamicMatrix(size_t m, size_t n, const Alloc& a = Alloc())
+    : TDynamicVector<T, Alloc>(checked_storage(m, n), a), nrows(m), ncols(n), ld(row_stride(m, n)) {}
+  TDynamicMatrix(size_t m, size_t n, TUninitializedTag, const Alloc& a = Alloc())
+    : TDynamicVector<T, Alloc>(checked_storage(m, n), UNINITIALIZED, a), nrows(m), ncols(n), ld(row_stride(m, n))
+  {
+    if (ld != ncols)
+      for (size_t i = 0; i < nrows; i++)
+        std::fill(pMem + i * ld + ncols, pMem + (i + 1) * ld, T());
+  }
+  TDynamicMatrix(const TDynamicMatrix& m) = default;
+  TDynamicMatrix(TDynamicMatrix&& m) noexcept
+    : TDynamicVector<T, Alloc>(std::move(m)), nrows(m.nrows), ncols(m.ncols), ld(m.ld)
+  {
+    m.nrows = m.ncols = m.ld = 0;
+  }
+  // вычисление матричного выражения одним проходом
+  template<typename E, typename = typename std::enable_if<TIsMatExpr<E>::value>::type>
+  TDynamicMatrix(const E& e, const Alloc& a = Alloc()) : TDynamicMatrix(e.rows(), e.cols(), UNINITIALIZED, a)
+  {
+    expr_assign_matrix(pMem, stride(), e);
+  }
+  TDynamicMatrix& operator=(const TDynamicMatrix& m) = default;
+  TDynamicMatrix& operator=(TDynamicMatrix&& m)
+    noexcept(std::is_nothrow_move_assignable<TDynamicVector<T, Alloc>>::value)
   {
+    TDynamicVector<T, Alloc>::operator=(std::move(static_cast<TDynamicVector<T, Alloc>&>(m)));
+    nrows = m.nrows;
+    ncols = m.ncols;
+    ld = m.ld;
+    if (m.data() == nullptr)
+      m.nrows = m.ncols = m.ld = 0;
+    return *this;
+  }
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix&>::type operator=(const E& e)
+  {
+    if (nrows != e.rows() || ncols != e.cols())
+    {
+      TDynamicMatrix tmp(e, get_allocator());
+      swap(*this, tmp);
+      return *this;
+    }
+    expr_assign_matrix(pMem, stride(), e);
+    return *this;
   }
 
-  // матрично-матричные операции
-  TDynamicMatrix operator+(const TDynamicMatrix& m)
+  // операции с присваиванием выполняются в памяти матрицы,
+  // C += A * B накапливает произведение прямо в C
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix&>::type operator+=(const E& e)
   {
+    expr_add_assign_matrix(pMem, stride(), *this, e);
+    return *this;
   }
-  TDynamicMatrix operator-(const TDynamicMatrix& m)
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix&>::type operator-=(const E& e)
   {
+    expr_assign_matrix(pMem, stride(), TMatBinary<TDynamicMatrix, E, TOpSub>(*this, e));
+    return *this;
   }
-  TDynamicMatrix operator*(const TDynamicMatrix& m)
+  TDynamicMatrix& operator*=(const T& val)
   {
+    scal(val, *this);
+    return *this;
   }
 
-  // ввод/вывод
+  // порядок квадратной матрицы (число строк)
+  size_t size() const noexcept { return nrows; }
+  size_t rows() const noexcept { return nrows; }
+  size_t cols() const noexcept { return ncols; }
+  // шаг строк в элементах: строка i начинается с data() + i * stride()
+  size_t stride() const noexcept { return ld; }
+  T* data() noexcept { return pMem; }
+  const T* data() const noexcept { return pMem; }
+  using TDynamicVector<T, Alloc>::get_allocator;
+
+  // индексация
+  TMatrixRow<T> operator[](size_t ind) noexcept
+  {
+    return TMatrixRow<T>(pMem + ind * stride(), ncols);
+  }
+  TMatrixRow<const T> operator[](size_t ind) const noexcept
+  {
+    return TMatrixRow<const T>(pMem + ind * stride(), ncols);
+  }
+  // индексация с контролем
+  TMatrixRow<T> at(size_t ind)
+  {
+    if (ind >= nrows)
+      throw out_of_range("Matrix index is out of range");
+    return (*this)[ind];
+  }
+  TMatrixRow<const T> at(size_t ind) const
+  {
+    if (ind >= nrows)
+      throw out_of_range("Matrix index is out of range");
+    return (*this)[ind];
+  }
+  // элемент для вычисления выражений
+  const T& operator()(size_t i, size_t j) const noexcept
+  {
+    return pMem[i * stride() + j];
+  }
+
+  // представления частей матрицы без копирования (tview.h): блок
+  // m x n с углом (r0, c0), строка, столбец и главная диагональ
+  TMatrixView<T> block(size_t r0, size_t c0, size_t m, size_t n)
+  {
+    return TMatrixView<T>(*this).block(r0, c0, m, n);
+  }
+  TMatrixView<const T> block(size_t r0, size_t c0, size_t m, size_t n) const
+  {
+    return TMatrixView<const T>(*this).block(r0, c0, m, n);
+  }
+  TMatrixRow<T> row(size_t i) { return at(i); }
+  TMatrixRow<const T> row(size_t i) const { return at(i); }
+  TVectorView<T> col(size_t j) { return TMatrixView<T>(*this).col(j); }
+  TVectorView<const T> col(size_t j) const { return TMatrixView<const T>(*this).col(j); }
+  TVectorView<T> diag() { return TMatrixView<T>(*this).diag(); }
+  TVectorView<const T> diag() const { return TMatrixView<const T>(*this).diag(); }
+
+  // сравнение
+  friend bool operator==(const TDynamicMatrix& a, const TDynamicMatrix& b) noexcept
+  {
+    if (a.nrows != b.nrows || a.ncols != b.ncols)
+      return false;
+    for (size_t i = 0; i < a.nrows; i++)
+      if (!std::equal(a[i].data(), a[i].data() + a.ncols, b[i].data()))
+        return false;
+    return true;
+  }
+  friend bool operator!=(const TDynamicMatrix& a, const TDynamicMatrix& b) noexcept
+  {
+    return !(a == b);
+  }
+
+  // матрично-скалярные, поэлементные матричные операции и произведение
+  // матриц возвращают ленивые выражения, матрица на вектор - сразу;
+  // операции с временной матрицей тоже вычисляются сразу
+
+  friend void swap(TDynamicMatrix& lhs, TDynamicMatrix& rhs) noexcept
+  {
+    swap(static_cast<TDynamicVector<T, Alloc>&>(lhs), static_cast<TDynamicVector<T, Alloc>&>(rhs));
+    std::swap(lhs.nrows, rhs.nrows);
+    std::swap(lhs.ncols, rhs.ncols);
+    std::swap(lhs.ld, rhs.ld);
+  }
+
+  // ввод/вывод: m строк по n элементов, размеры задаются матрицей
   friend istream& operator>>(istream& istr, TDynamicMatrix& v)
   {
+    for (size_t i = 0; i < v.nrows; i++)
+      for (size_t j = 0; j < v.ncols; j++)
+        istr >> v[i][j];
+    return istr;
   }
   friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
   {
+    for (size_t i = 0; i < v.nrows; i++)
+    {
+      for (size_t j = 0; j < v.ncols; j++)
+        ostr << v[i][j] << ' ';
+      ostr << endl;
+    }
+    return ostr;
+  }
+};
+
+template<typename T, typename Alloc>
+const size_t TDynamicMatrix<T, Alloc, TRowMajor>::ROW_ALIGN;
+
+template<typename T, typename Alloc>
+struct TExprStore<TDynamicMatrix<T, Alloc>>
+{
+  typedef const TDynamicMatrix<T, Alloc>& type;
+};
+template<typename T, typename Alloc>
+struct TIsContiguous<TDynamicMatrix<T, Alloc>> : std::true_type {};
+
+// Операнд умножения: матрица или вектор используются как есть,
+// выражение вычисляется во временный объект
+template<typename T, typename A>
+const TDynamicMatrix<T, A>& materialize(const TDynamicMatrix<T, A>& m) noexcept
+{
+  return m;
+}
+template<typename E>
+typename std::enable_if<TIsMatExpr<E>::value, TDynamicMatrix<typename E::value_type>>::type
+materialize(const E& e)
+{
+  return TDynamicMatrix<typename E::value_type>(e);
+}
+template<typename T, typename A>
+const TDynamicVector<T, A>& materialize(const TDynamicVector<T, A>& v) noexcept
+{
+  return v;
+}
+template<typename E>
+typename std::enable_if<TIsVecExpr<E>::value, TDynamicVector<typename E::value_type>>::type
+materialize(const E& e)
+{
+  return TDynamicVector<typename E::value_type>(e);
+}
+
+// ---------------- операции в стиле BLAS ----------------
+// Результат записывается в переданный объект без выделения памяти,
+// на этих функциях построены соответствующие операторы
+
+// x = alpha * x для векторов и представлений с шагом
+template<typename T, typename X>
+typename std::enable_if<TIsVecExpr<typename std::decay<X>::type>::value &&
+  TIsDirectOf<typename std::decay<X>::type, T>::value>::type
+scal(const T& alpha, X&& x)
+{
+  const size_t n = x.size(), inc = expr_inc(x);
+  T* p = x.data();
+  if (inc == 1)
+    vec_kernels<T>().mul_scalar(p, alpha, p, n);
+  else
+    for (size_t i = 0; i < n; i++)
+      p[i * inc] *= alpha;
+}
+// X = alpha * X для построчно хранимых матриц
+template<typename T, typename X>
+typename std::enable_if<TIsMatExpr<typename std::decay<X>::type>::value &&
+  TIsContiguousOf<typename std::decay<X>::type, T>::value>::type
+scal(const T& alpha, X&& x)
+{
+  const TVecKernels<T>& k = vec_kernels<T>();
+  T* p = x.data();
+  for (size_t i = 0; i < x.rows(); i++)
+    k.mul_scalar(p + i * x.stride(), alpha, p + i * x.stride(), x.cols());
+}
+
+// y = alpha * x + y
+template<typename T, typename X, typename Y>
+typename std::enable_if<TIsVecExpr<X>::value && TIsDirectOf<X, T>::value &&
+  TIsDirectOf<typename std::decay<Y>::type, T>::value>::type
+axpy(const T& alpha, const X& x, Y&& y)
+{
+  const size_t n = x.size(), incy = expr_inc(y);
+  if (n != y.size())
+    throw length_error("Vectors should have equal size");
+  T* py = y.data();
+  if (incy == 1 && expr_inc(x) == 1)
+    vec_kernels<T>().axpy(alpha, x.data(), py, n);
+  else
+    for (size_t i = 0; i < n; i++)
+      py[i * incy] += alpha * x[i];
+}
+template<typename T, typename X, typename Y>
+typename std::enable_if<TIsMatExpr<X>::value && TIsContiguousOf<X, T>::value &&
+  TIsContiguousOf<typename std::decay<Y>::type, T>::value>::type
+axpy(const T& alpha, const X& x, Y&& y)
+{
+  const size_t m = x.rows(), n = x.cols();
+  if (m != y.rows() || n != y.cols())
+    throw length_error("Matrices should have equal size");
+  const TVecKernels<T>& k = vec_kernels<T>();
+  T* py = y.data();
+  for (size_t i = 0; i < m; i++)
+    k.axpy(alpha, x.data() + i * x.stride(), py + i * y.stride(), n);
+}
+
+// y = alpha * A * x + beta * y; при beta = 0 прежнее значение y не читается.
+// A - любая построчно хранимая матрица m x n с data() и stride(), x и y -
+// векторы или представления с шагом
+template<typename T, typename M, typename X, typename Y>
+typename std::enable_if<TIsExprOf<M, T, TMatExprTag>::value && TIsContiguous<M>::value &&
+  TIsVecExpr<X>::value && TIsDirectOf<X, T>::value && TIsDirectOf<typename std::decay<Y>::type, T>::value>::type
+gemv(const T& alpha, const M& a, const X& x, const T& beta, Y&& y)
+{
+  const size_t m = a.rows(), n = a.cols(), incx = expr_inc(x), incy = expr_inc(y);
+  if (n != x.size() || m != y.size())
+    throw length_error("Matrix and vector sizes do not match");
+  T* py = y.data();
+  const T* px = x.data();
+  // x с шагом или пересекающийся с y копируется во временный вектор
+  if (incx != 1 || mem_overlap(px, n, static_cast<const T*>(py), (m - 1) * incy + 1))
+  {
+    gemv(alpha, a, TDynamicVector<T>(x), beta, std::forward<Y>(y));
+    return;
+  }
+  const TVecKernels<T>& k = vec_kernels<T>();
+  for (size_t i = 0; i < m; i++)
+  {
+    const T s = alpha * k.dot(a.data() + i * a.stride(), px, n);
+    py[i * incy] = beta == T() ? s : s + beta * py[i * incy];
+  }
+}
+
+// C = alpha * A * B + beta * C для A (m x k), B (k x n), C (m x n) в памяти
+// a, b, c с шагами строк lda, ldb, ldc.
+// Ядро выбирается по форме матриц (gemm_shaped). Если c пересекается
+// с a или b, произведение считается во временный буфер
+template<typename T>
+void gemm_strided(size_t m, size_t n, size_t k, const T& alpha, const T* a, size_t lda,
+  const T* b, size_t ldb, const T& beta, T* c, size_t ldc)
+{
+  const TVecKernels<T>& vk = vec_kernels<T>();
+  const size_t ext = (m - 1) * ldc + n;
+  if (mem_overlap(a, (m - 1) * lda + k, static_cast<const T*>(c), ext) ||
+    mem_overlap(b, (k - 1) * ldb + n, static_cast<const T*>(c), ext))
+  {
+    TDynamicVector<T> tmp(m * n, UNINITIALIZED);
+    gemm_shaped(m, n, k, alpha, a, lda, b, ldb, T(), tmp.data(), n);
+    for (size_t i = 0; i < m; i++)
+    {
+      const T* t = tmp.data() + i * n;
+      T* ci = c + i * ldc;
+      if (beta == T())
+        std::copy(t, t + n, ci);
+      else
+      {
+        if (beta != T(1))
+          vk.mul_scalar(ci, beta, ci, n);
+        vk.add(ci, t, ci, n);
+      }
+    }
+    return;
+  }
+  gemm_shaped(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+
+// C = alpha * A * B + beta * C для построчно хранимых матриц и их
+// представлений; при beta = 0 прежнее значение C не читается
+template<typename T, typename MA, typename MB, typename MC>
+typename std::enable_if<TIsMatExpr<MA>::value && TIsContiguousOf<MA, T>::value &&
+  TIsContiguousOf<MB, T>::value && TIsContiguousOf<typename std::decay<MC>::type, T>::value>::type
+gemm(const T& alpha, const MA& a, const MB& b, const T& beta, MC&& c)
+{
+  if (a.cols() != b.rows() || a.rows() != c.rows() || b.cols() != c.cols())
+    throw length_error("Matrix sizes do not match");
+  gemm_strided(a.rows(), b.cols(), a.cols(), alpha, a.data(), a.stride(), b.data(), b.stride(),
+    beta, c.data(), c.stride());
+}
+
+// B = A^T для A (m x n) в памяти a и B (n x m) в памяти b с шагами строк
+// lda, ldb. Обход блоками: построчное чтение одной матрицы не вытесняет
+// из кэша строки другой, читаемой по столбцам. a и b не пересекаются
+template<typename T>
+void transpose_strided(size_t m, size_t n, const T* a, size_t lda, T* b, size_t ldb)
+{
+  for (size_t i0 = 0; i0 < m; i0 += TRANSPOSE_BLOCK)
+    for (size_t j0 = 0; j0 < n; j0 += TRANSPOSE_BLOCK)
+    {
+      const size_t i1 = std::min(i0 + TRANSPOSE_BLOCK, m), j1 = std::min(j0 + TRANSPOSE_BLOCK, n);
+      for (size_t j = j0; j < j1; j++)
+        for (size_t i = i0; i < i1; i++)
+          b[j * ldb + i] = a[i * lda + j];
+    }
+}
+
+// B = A^T для построчно хранимых матриц и их представлений;
+// при пересечении A и B транспонируется копия A
+template<typename A, typename B>
+typename std::enable_if<TIsMatExpr<A>::value && TIsContiguous<A>::value &&
+  TIsContiguousOf<typename std::decay<B>::type, typename A::value_type>::value>::type
+transpose(const A& a, B&& b)
+{
+  typedef typename A::value_type T;
+  const size_t m = a.rows(), n = a.cols();
+  if (b.rows() != n || b.cols() != m)
+    throw length_error("Matrix sizes do not match");
+  const T* pa = a.data();
+  const size_t lda = a.stride();
+  if (mem_overlap(pa, (m - 1) * lda + n, static_cast<const T*>(b.data()), (n - 1) * b.stride() + m))
+  {
+    TDynamicVector<T> tmp(m * n, UNINITIALIZED);
+    for (size_t i = 0; i < m; i++)
+      std::copy(pa + i * lda, pa + i * lda + n, tmp.data() + i * n);
+    transpose_strided(m, n, static_cast<const T*>(tmp.data()), n, b.data(), b.stride());
+    return;
+  }
+  transpose_strided(m, n, pa, lda, b.data(), b.stride());
+}
+
+// A = A^T на месте для квадратной матрицы или представления:
+// блоки по разные стороны диагонали меняются местами
+template<typename M>
+typename std::enable_if<TIsMatExpr<typename std::decay<M>::type>::value &&
+  TIsContiguous<typename std::decay<M>::type>::value>::type
+transpose(M&& a)
+{
+  const size_t n = a.rows(), ld = a.stride();
+  if (n != a.cols())
+    throw length_error("Matrix should be square");
+  auto* p = a.data();
+  for (size_t i0 = 0; i0 < n; i0 += TRANSPOSE_BLOCK)
+    for (size_t j0 = i0; j0 < n; j0 += TRANSPOSE_BLOCK)
+    {
+      const size_t i1 = std::min(i0 + TRANSPOSE_BLOCK, n), j1 = std::min(j0 + TRANSPOSE_BLOCK, n);
+      for (size_t i = i0; i < i1; i++)
+        for (size_t j = i0 == j0 ? i + 1 : j0; j < j1; j++)
+          std::swap(p[i * ld + j], p[j * ld + i]);
+    }
+}
+
+// матрично-векторные операции
+template<typename EM, typename EV>
+typename std::enable_if<TIsMatExpr<EM>::value && TIsVecExpr<EV>::value,
+  TDynamicVector<typename EM::value_type>>::type
+operator*(const EM& em, const EV& ev)
+{
+  typedef typename EM::value_type T;
+  const auto& m = materialize(em);
+  const auto& v = materialize(ev);
+  if (m.cols() != v.size())
+    throw length_error("Matrix and vector sizes do not match");
+  TDynamicVector<T> res(m.rows(), UNINITIALIZED);
+  gemv(T(1), m, v, T(), res);
+  return res;
+}
+
+// Произведение матриц -
+// ленивое выражение: при присваивании и в C += A * B вычисляется ядром
+// умножения прямо в память результата, внутри других выражений -
+// один раз во временную матрицу
+template<typename L, typename R>
+class TMatProduct
+{
+  typedef typename L::value_type T;
+  typename TExprStore<L>::type l;
+  typename TExprStore<R>::type r;
+  mutable std::shared_ptr<TDynamicMatrix<T>> res;
+public:
+  typedef TMatExprTag expr_category;
+  typedef T value_type;
+
+  TMatProduct(const L& lhs, const R& rhs) : l(lhs), r(rhs)
+  {
+    if (l.cols() != r.rows())
+      throw length_error("Matrix sizes do not match");
+  }
+
+  size_t rows() const noexcept { return l.rows(); }
+  size_t cols() const noexcept { return r.cols(); }
+  T operator()(size_t i, size_t j) const { return result()(i, j); }
+
+  const L& left() const noexcept { return l; }
+  const R& right() const noexcept { return r; }
+
+  const TDynamicMatrix<T>& result() const
+  {
+    if (!res)
+      res = std::make_shared<TDynamicMatrix<T>>(*this);
+    return *res;
+  }
+
+  // dst = A * B, ld - шаг строк dst
+  void assign_to(T* dst, size_t ld) const
+  {
+    if (res)
+    {
+      for (size_t i = 0; i < rows(); i++)
+        std::copy((*res)[i].data(), (*res)[i].data() + cols(), dst + i * ld);
+      return;
+    }
+    const auto& a = materialize(l);
+    const auto& b = materialize(r);
+    gemm_strided(rows(), cols(), a.cols(), T(1), a.data(), a.stride(), b.data(), b.stride(), T(), dst, ld);
+  }
+  // dst += A * B
+  void add_to(T* dst, size_t ld) const
+  {
+    const auto& a = materialize(l);
+    const auto& b = materialize(r);
+    gemm_strided(rows(), cols(), a.cols(), T(1), a.data(), a.stride(), b.data(), b.stride(), T(1), dst, ld);
   }
 };
 
+template<typename T, typename L, typename R>
+void expr_assign_matrix(T* dst, size_t ld, const TMatProduct<L, R>& e)
+{
+  e.assign_to(dst, ld);
+}
+
+// Прибавление выражения к матрице m с памятью dst и шагом строк ld
+template<typename T, typename M, typename E>
+void expr_add_assign_matrix(T* dst, size_t ld, const M& m, const E& e)
+{
+  expr_assign_matrix(dst, ld, TMatBinary<M, E, TOpAdd>(m, e));
+}
+template<typename T, typename M, typename L, typename R>
+void expr_add_assign_matrix(T* dst, size_t ld, const M& m, const TMatProduct<L, R>& e)
+{
+  if (m.rows() != e.rows() || m.cols() != e.cols())
+    throw length_error("Matrices should have equal size");
+  e.add_to(dst, ld);
+}
+
+// матрично-матричные операции
+template<typename L, typename R>
+typename std::enable_if<TIsMatExpr<L>::value && TIsMatExpr<R>::value, TMatProduct<L, R>>::type
+operator*(const L& l, const R& r)
+{
+  return TMatProduct<L, R>(l, r);
+}
+
+// Операции над временными матрицами вычисляются в памяти временного
+// операнда; произведение, прибавляемое к временной матрице, накапливается
+// в ней ядром умножения
+template<typename T, typename A>
+TDynamicMatrix<T, A> operator*(TDynamicMatrix<T, A>&& m, typename TDynamicMatrix<T, A>::value_type val)
+{
+  m *= val;
+  return std::move(m);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TMatExprTag>::value, TDynamicMatrix<T, A>>::type
+operator+(TDynamicMatrix<T, A>&& l, const E& r)
+{
+  l += r;
+  return std::move(l);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TMatExprTag>::value, TDynamicMatrix<T, A>>::type
+operator+(const E& l, TDynamicMatrix<T, A>&& r)
+{
+  r += l;
+  return std::move(r);
+}
+template<typename T, typename A>
+TDynamicMatrix<T, A> operator+(TDynamicMatrix<T, A>&& l, TDynamicMatrix<T, A>&& r)
+{
+  l += r;
+  return std::move(l);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TMatExprTag>::value, TDynamicMatrix<T, A>>::type
+operator-(TDynamicMatrix<T, A>&& l, const E& r)
+{
+  l -= r;
+  return std::move(l);
+}
+template<typename T, typename A, typename E>
+typename std::enable_if<TIsExprOf<E, T, TMatExprTag>::value, TDynamicMatrix<T, A>>::type
+operator-(const E& l, TDynamicMatrix<T, A>&& r)
+{
+  expr_assign_matrix(r.data(), r.stride(), TMatBinary<E, TDynamicMatrix<T, A>, TOpSub>(l, r));
+  return std::move(r);
+}
+template<typename T, typename A>
+TDynamicMatrix<T, A> operator-(TDynamicMatrix<T, A>&& l, TDynamicMatrix<T, A>&& r)
+{
+  l -= r;
+  return std::move(l);
+}
+// произведение с временной матрицей вычисляется сразу: ленивое выражение
+// хранило бы ссылку на операнд, разрушаемый в конце полного выражения
+template<typename T, typename A, typename Layout, typename E>
+typename std::enable_if<TIsExprOf<E, T, TMatExprTag>::value, TDynamicMatrix<T, A, Layout>>::type
+operator*(TDynamicMatrix<T, A, Layout>&& l, const E& r)
+{
+  return TDynamicMatrix<T, A, Layout>(TMatProduct<TDynamicMatrix<T, A, Layout>, E>(l, r), l.get_allocator());
+}
+template<typename T, typename A, typename Layout, typename E>
+typename std::enable_if<TIsExprOf<E, T, TMatExprTag>::value, TDynamicMatrix<T, A, Layout>>::type
+operator*(const E& l, TDynamicMatrix<T, A, Layout>&& r)
+{
+  return TDynamicMatrix<T, A, Layout>(TMatProduct<E, TDynamicMatrix<T, A, Layout>>(l, r), r.get_allocator());
+}
+template<typename T, typename A, typename Layout, typename B, typename RLayout>
+TDynamicMatrix<T, A, Layout> operator*(TDynamicMatrix<T, A, Layout>&& l, TDynamicMatrix<T, B, RLayout>&& r)
+{
+  return TDynamicMatrix<T, A, Layout>(TMatProduct<TDynamicMatrix<T, A, Layout>, TDynamicMatrix<T, B, RLayout>>(l, r),
+    l.get_allocator());
+}
+
+#include "tview.h"
+
 #endif
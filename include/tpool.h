@@ -0,0 +1,215 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Пул буферов для векторов и матриц.
+// Освобождённый буфер остаётся в пуле в списке своего класса размеров
+// и отдаётся следующему запросу того же класса без обращения к куче
+
+#ifndef __TBufferPool_H__
+#define __TBufferPool_H__
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include "tmatrix.h"
+
+// Статистика пула
+struct TPoolStats
+{
+  size_t hits;        // запросы, обслуженные из пула
+  size_t misses;      // запросы, ушедшие в кучу
+  size_t returns;     // буферы, возвращённые в пул
+  size_t drops;       // буферы, освобождённые из-за ограничений
+  size_t bytes_held;  // байт в буферах, хранящихся в пуле
+
+  double hit_rate() const noexcept
+  {
+    return hits + misses == 0 ? 0.0 : double(hits) / double(hits + misses);
+  }
+};
+
+// Пул буферов -
+// классы размеров: 4 класса на каждую степень двойки (запрос округляется
+// вверх не более чем на 25%), наименьший класс - MIN_BLOCK байт.
+// У каждого класса свой список свободных буферов под своим мьютексом.
+// Ограничения: наибольший хранимый буфер и общий объём хранимых буферов.
+// Буферы выравниваются на TMATRIX_ALIGNMENT байт
+class TBufferPool
+{
+  static const size_t MIN_BLOCK = 64;
+  static const size_t CLASS_COUNT = 1 + 4 * (8 * sizeof(size_t) - 6);
+
+  struct TClass
+  {
+    std::mutex lock;
+    std::vector<void*> free;
+  };
+  TClass classes[CLASS_COUNT];
+  std::atomic<size_t> max_held;
+  std::atomic<size_t> max_block;
+  std::atomic<size_t> held;
+  std::atomic<size_t> hits, misses, returns, drops;
+
+  // класс размера bytes и округлённый размер буфера этого класса
+  static size_t class_of(size_t bytes, size_t& rounded) noexcept
+  {
+    if (bytes <= MIN_BLOCK)
+    {
+      rounded = MIN_BLOCK;
+      return 0;
+    }
+    size_t k = 6;   // 2^k <= bytes - 1 < 2^(k+1)
+    while (((bytes - 1) >> (k + 1)) != 0)
+      k++;
+    const size_t step = size_t(1) << (k - 2);
+    const size_t m = (bytes - 1) / step + 1;   // 5..8
+    rounded = m * step;
+    return 1 + 4 * (k - 6) + (m - 5);
+  }
+public:
+  explicit TBufferPool(size_t max_bytes_held = size_t(1) << 30, size_t max_block_bytes = size_t(1) << 28)
+    : max_held(max_bytes_held), max_block(max_block_bytes), held(0), hits(0), misses(0), returns(0), drops(0) {}
+  TBufferPool(const TBufferPool&) = delete;
+  TBufferPool& operator=(const TBufferPool&) = delete;
+  ~TBufferPool()
+  {
+    trim();
+  }
+
+  // общий пул процесса. Пул не разрушается при выходе: статические
+  // матрицы, созданные до первого обращения к пулу, возвращают буферы
+  // в него уже после разрушения локальных статических объектов
+  static TBufferPool& instance()
+  {
+    static TBufferPool* const pool = new TBufferPool();
+    return *pool;
+  }
+
+  // ограничения: общий объём хранимых буферов и наибольший хранимый буфер.
+  // Уже хранимые буферы не освобождаются, для этого есть trim()
+  void set_limits(size_t max_bytes_held, size_t max_block_bytes) noexcept
+  {
+    max_held = max_bytes_held;
+    max_block = max_block_bytes;
+  }
+
+  // буфер не меньше bytes байт
+  void* acquire(size_t bytes)
+  {
+    size_t rounded;
+    const size_t c = class_of(bytes, rounded);
+    if (rounded <= max_block)
+    {
+      TClass& cl = classes[c];
+      std::lock_guard<std::mutex> g(cl.lock);
+      if (!cl.free.empty())
+      {
+        void* p = cl.free.back();
+        cl.free.pop_back();
+        held -= rounded;
+        hits++;
+        return p;
+      }
+    }
+    misses++;
+    return aligned_allocate(rounded, TMATRIX_ALIGNMENT);
+  }
+  // возврат буфера, полученного acquire(bytes)
+  void release(void* p, size_t bytes) noexcept
+  {
+    size_t rounded;
+    const size_t c = class_of(bytes, rounded);
+    if (rounded <= max_block)
+    {
+      // место в пуле резервируется до вставки в список
+      size_t h = held.load();
+      while (h + rounded <= max_held && !held.compare_exchange_weak(h, h + rounded))
+        ;
+      if (h + rounded <= max_held)
+      {
+        TClass& cl = classes[c];
+        try
+        {
+          std::lock_guard<std::mutex> g(cl.lock);
+          cl.free.push_back(p);
+          returns++;
+          return;
+        }
+        catch (...)
+        {
+          held -= rounded;
+        }
+      }
+    }
+    drops++;
+    aligned_deallocate(p);
+  }
+
+  // освобождение всех хранимых буферов
+  void trim() noexcept
+  {
+    for (size_t c = 0; c < CLASS_COUNT; c++)
+    {
+      std::lock_guard<std::mutex> g(classes[c].lock);
+      for (size_t i = 0; i < classes[c].free.size(); i++)
+        aligned_deallocate(classes[c].free[i]);
+      classes[c].free.clear();
+    }
+    held = 0;
+  }
+
+  TPoolStats stats() const noexcept
+  {
+    return TPoolStats{ hits.load(), misses.load(), returns.load(), drops.load(), held.load() };
+  }
+  void reset_stats() noexcept
+  {
+    hits = misses = returns = drops = 0;
+  }
+};
+
+// Распределитель на пуле буферов (по умолчанию - общем пуле процесса)
+template<typename T>
+class TPoolAllocator
+{
+  TBufferPool* pPool;
+  template<typename U> friend class TPoolAllocator;
+public:
+  typedef T value_type;
+
+  TPoolAllocator() noexcept : pPool(&TBufferPool::instance()) {}
+  explicit TPoolAllocator(TBufferPool& p) noexcept : pPool(&p) {}
+  template<typename U>
+  TPoolAllocator(const TPoolAllocator<U>& a) noexcept : pPool(a.pPool) {}
+
+  TBufferPool* pool() const noexcept { return pPool; }
+
+  T* allocate(size_t n)
+  {
+    return static_cast<T*>(pPool->acquire(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) noexcept
+  {
+    pPool->release(p, n * sizeof(T));
+  }
+
+  friend bool operator==(const TPoolAllocator& a, const TPoolAllocator& b) noexcept
+  {
+    return a.pPool == b.pPool;
+  }
+  friend bool operator!=(const TPoolAllocator& a, const TPoolAllocator& b) noexcept
+  {
+    return a.pPool != b.pPool;
+  }
+};
+
+// Векторы и матрицы на пуле буферов
+template<typename T>
+using TPoolVector = TDynamicVector<T, TPoolAllocator<T>>;
+template<typename T>
+using TPoolMatrix = TDynamicMatrix<T, TPoolAllocator<T>>;
+
+#endif
@@ -0,0 +1,514 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Векторные ядра SSE2/AVX2/AVX-512 с выбором по CPUID во время выполнения
+
+#ifndef __TSIMD_H__
+#define __TSIMD_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TMATRIX_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#include <cpuid.h>
+#endif
+#endif
+
+// Разрешение набора инструкций для отдельной функции или участка кода.
+// MSVC позволяет использовать intrinsic-функции без флагов компиляции
+#define TMATRIX_PRAGMA(x) _Pragma(#x)
+#if defined(__clang__)
+#define TMATRIX_TARGET(isa) __attribute__((target(isa)))
+#define TMATRIX_BEGIN_TARGET(isa) TMATRIX_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define TMATRIX_END_TARGET TMATRIX_PRAGMA(clang attribute pop)
+#elif defined(__GNUC__)
+#define TMATRIX_TARGET(isa) __attribute__((target(isa)))
+#define TMATRIX_BEGIN_TARGET(isa) TMATRIX_PRAGMA(GCC push_options) TMATRIX_PRAGMA(GCC target(isa))
+#define TMATRIX_END_TARGET TMATRIX_PRAGMA(GCC pop_options)
+#else
+#define TMATRIX_TARGET(isa)
+#define TMATRIX_BEGIN_TARGET(isa)
+#define TMATRIX_END_TARGET
+#endif
+
+// Уровни набора векторных инструкций
+enum TSimdLevel
+{
+  SIMD_PORTABLE = 0,
+  SIMD_SSE2,
+  SIMD_AVX2,
+  SIMD_AVX512
+};
+
+// Возможности процессора, определяются один раз через CPUID
+struct TCpuFeatures
+{
+  bool sse2 = false;
+  bool avx2 = false;
+  bool fma = false;
+  bool avx512f = false;
+  bool avx512dq = false;
+
+  // наилучший уровень, поддерживаемый процессором и ОС
+  TSimdLevel level() const noexcept
+  {
+    if (avx512f && avx512dq)
+      return SIMD_AVX512;
+    if (avx2)
+      return SIMD_AVX2;
+    if (sse2)
+      return SIMD_SSE2;
+    return SIMD_PORTABLE;
+  }
+
+  static TCpuFeatures detect()
+  {
+    TCpuFeatures f;
+#ifdef TMATRIX_X86
+    unsigned r[4] = { 0, 0, 0, 0 };
+    cpuid(0, r);
+    const unsigned max_leaf = r[0];
+    cpuid(1, r);
+    f.sse2 = (r[3] & (1u << 26)) != 0;
+    const bool osxsave = (r[2] & (1u << 27)) != 0;
+    const bool avx = (r[2] & (1u << 28)) != 0;
+    f.fma = (r[2] & (1u << 12)) != 0;
+    // ОС должна сохранять регистры YMM (биты 1-2 XCR0) и ZMM (биты 5-7)
+    const unsigned long long xcr0 = osxsave ? xgetbv() : 0;
+    const bool os_ymm = (xcr0 & 0x6) == 0x6;
+    const bool os_zmm = (xcr0 & 0xe6) == 0xe6;
+    f.fma = f.fma && avx && os_ymm;
+    if (max_leaf >= 7)
+    {
+      cpuid(7, r);
+      f.avx2 = avx && os_ymm && (r[1] & (1u << 5)) != 0;
+      f.avx512f = os_zmm && (r[1] & (1u << 16)) != 0;
+      f.avx512dq = os_zmm && (r[1] & (1u << 17)) != 0;
+    }
+#endif
+    return f;
+  }
+
+private:
+#ifdef TMATRIX_X86
+  static void cpuid(unsigned leaf, unsigned r[4])
+  {
+#if defined(_MSC_VER)
+    int x[4];
+    __cpuidex(x, int(leaf), 0);
+    for (int i = 0; i < 4; i++)
+      r[i] = unsigned(x[i]);
+#else
+    __cpuid_count(leaf, 0, r[0], r[1], r[2], r[3]);
+#endif
+  }
+  static unsigned long long xgetbv()
+  {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+  }
+#endif
+};
+
+inline const TCpuFeatures& cpu_features()
+{
+  static const TCpuFeatures f = TCpuFeatures::detect();
+  return f;
+}
+
+// Таблица поэлементных ядер для типа T
+template<typename T>
+struct TVecKernels
+{
+  void (*add)(const T* a, const T* b, T* c, size_t n);
+  void (*sub)(const T* a, const T* b, T* c, size_t n);
+  void (*add_scalar)(const T* a, T val, T* c, size_t n);
+  void (*sub_scalar)(const T* a, T val, T* c, size_t n);
+  void (*mul_scalar)(const T* a, T val, T* c, size_t n);
+  void (*axpy)(T alpha, const T* x, T* y, size_t n);
+  T (*dot)(const T* a, const T* b, size_t n);
+  T (*dot_compensated)(const T* a, const T* b, size_t n);
+};
+
+// Скалярное произведение считается блоками по DOT_BLOCK элементов
+// несколькими независимыми аккумуляторами, суммы блоков складываются
+// попарно: погрешность растёт как O(log(n)), а не O(n)
+const size_t DOT_BLOCK = 1024;
+
+// размер первой половины при попарном суммировании, кратный DOT_BLOCK
+inline size_t dot_pairwise_split(size_t n) noexcept
+{
+  return (n + DOT_BLOCK - 1) / DOT_BLOCK / 2 * DOT_BLOCK;
+}
+
+// Суммирование с компенсацией Ноймайера: c накапливает потерянные
+// младшие разряды, погрешность не зависит от числа слагаемых
+template<typename T>
+struct TNeumaierSum
+{
+  T s = T();
+  T c = T();
+
+  void add(T x)
+  {
+    const T t = s + x;
+    if ((s < T() ? -s : s) >= (x < T() ? -x : x))
+      c += (s - t) + x;
+    else
+      c += (x - t) + s;
+    s = t;
+  }
+  T result() const { return s + c; }
+};
+
+// Переносимые ядра для произвольного T
+template<typename T>
+void vec_add_portable(const T* a, const T* b, T* c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    c[i] = a[i] + b[i];
+}
+template<typename T>
+void vec_sub_portable(const T* a, const T* b, T* c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    c[i] = a[i] - b[i];
+}
+template<typename T>
+void vec_add_scalar_portable(const T* a, T val, T* c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    c[i] = a[i] + val;
+}
+template<typename T>
+void vec_sub_scalar_portable(const T* a, T val, T* c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    c[i] = a[i] - val;
+}
+template<typename T>
+void vec_mul_scalar_portable(const T* a, T val, T* c, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    c[i] = a[i] * val;
+}
+template<typename T>
+void vec_axpy_portable(T alpha, const T* x, T* y, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    y[i] += alpha * x[i];
+}
+template<typename T>
+T vec_dot_portable(const T* a, const T* b, size_t n)
+{
+  if (n > DOT_BLOCK)
+  {
+    const size_t h = dot_pairwise_split(n);
+    return vec_dot_portable(a, b, h) + vec_dot_portable(a + h, b + h, n - h);
+  }
+  // четыре аккумулятора разрывают зависимость между итерациями
+  T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    s0 += a[i] * b[i];
+    s1 += a[i + 1] * b[i + 1];
+    s2 += a[i + 2] * b[i + 2];
+    s3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; i++)
+    s0 += a[i] * b[i];
+  return (s0 + s1) + (s2 + s3);
+}
+template<typename T>
+T vec_dot_compensated_portable(const T* a, const T* b, size_t n, std::true_type)
+{
+  TNeumaierSum<T> sum;
+  for (size_t i = 0; i < n; i++)
+    sum.add(a[i] * b[i]);
+  return sum.result();
+}
+template<typename T>
+T vec_dot_compensated_portable(const T* a, const T* b, size_t n, std::false_type)
+{
+  return vec_dot_portable(a, b, n);
+}
+// компенсация имеет смысл только для чисел с плавающей точкой
+template<typename T>
+T vec_dot_compensated_portable(const T* a, const T* b, size_t n)
+{
+  return vec_dot_compensated_portable(a, b, n, std::is_floating_point<T>());
+}
+
+template<typename T>
+struct TVecKernelsPortable
+{
+  static const TVecKernels<T>& table()
+  {
+    static const TVecKernels<T> k = { &vec_add_portable<T>, &vec_sub_portable<T>,
+      &vec_add_scalar_portable<T>, &vec_sub_scalar_portable<T>,
+      &vec_mul_scalar_portable<T>, &vec_axpy_portable<T>, &vec_dot_portable<T>,
+      &vec_dot_compensated_portable<T> };
+    return k;
+  }
+};
+
+#ifdef TMATRIX_X86
+// Операции над регистрами: для каждого набора инструкций и типа элемента
+// задаются тип регистра V, ширина W и примитивы load/store/set1/add/sub/mul.
+// Целочисленное умножение, отсутствующее в наборе, собирается из _mul_epu32
+
+// ---------------- SSE2 ----------------
+TMATRIX_BEGIN_TARGET("sse2")
+namespace tsimd_sse2
+{
+template<typename T> struct TOps;
+
+template<> struct TOps<float>
+{
+  typedef __m128 V;
+  static const size_t W = 4;
+  static V load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+  static V set1(float x) { return _mm_set1_ps(x); }
+  static V zero() { return _mm_setzero_ps(); }
+  static V add(V a, V b) { return _mm_add_ps(a, b); }
+  static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+  static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+};
+template<> struct TOps<double>
+{
+  typedef __m128d V;
+  static const size_t W = 2;
+  static V load(const double* p) { return _mm_loadu_pd(p); }
+  static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+  static V set1(double x) { return _mm_set1_pd(x); }
+  static V zero() { return _mm_setzero_pd(); }
+  static V add(V a, V b) { return _mm_add_pd(a, b); }
+  static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+  static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+};
+template<> struct TOps<int32_t>
+{
+  typedef __m128i V;
+  static const size_t W = 4;
+  static V load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static void store(int32_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+  static V set1(int32_t x) { return _mm_set1_epi32(x); }
+  static V zero() { return _mm_setzero_si128(); }
+  static V add(V a, V b) { return _mm_add_epi32(a, b); }
+  static V sub(V a, V b) { return _mm_sub_epi32(a, b); }
+  static V mul(V a, V b)
+  {
+    const V even = _mm_mul_epu32(a, b);
+    const V odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+      _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  }
+};
+template<> struct TOps<int64_t>
+{
+  typedef __m128i V;
+  static const size_t W = 2;
+  static V load(const int64_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static void store(int64_t* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+  static V set1(int64_t x) { return _mm_set1_epi64x(x); }
+  static V zero() { return _mm_setzero_si128(); }
+  static V add(V a, V b) { return _mm_add_epi64(a, b); }
+  static V sub(V a, V b) { return _mm_sub_epi64(a, b); }
+  static V mul(V a, V b)
+  {
+    const V lo = _mm_mul_epu32(a, b);
+    const V cross = _mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(a, 32), b),
+      _mm_mul_epu32(a, _mm_srli_epi64(b, 32)));
+    return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+  }
+};
+
+#include "tsimd_kernels.h"
+}
+TMATRIX_END_TARGET
+
+// ---------------- AVX2 ----------------
+TMATRIX_BEGIN_TARGET("avx2,fma")
+namespace tsimd_avx2
+{
+template<typename T> struct TOps;
+
+template<> struct TOps<float>
+{
+  typedef __m256 V;
+  static const size_t W = 8;
+  static V load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+  static V set1(float x) { return _mm256_set1_ps(x); }
+  static V zero() { return _mm256_setzero_ps(); }
+  static V add(V a, V b) { return _mm256_add_ps(a, b); }
+  static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+  static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+};
+template<> struct TOps<double>
+{
+  typedef __m256d V;
+  static const size_t W = 4;
+  static V load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+  static V set1(double x) { return _mm256_set1_pd(x); }
+  static V zero() { return _mm256_setzero_pd(); }
+  static V add(V a, V b) { return _mm256_add_pd(a, b); }
+  static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+  static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+};
+template<> struct TOps<int32_t>
+{
+  typedef __m256i V;
+  static const size_t W = 8;
+  static V load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  static void store(int32_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+  static V set1(int32_t x) { return _mm256_set1_epi32(x); }
+  static V zero() { return _mm256_setzero_si256(); }
+  static V add(V a, V b) { return _mm256_add_epi32(a, b); }
+  static V sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+  static V mul(V a, V b) { return _mm256_mullo_epi32(a, b); }
+};
+template<> struct TOps<int64_t>
+{
+  typedef __m256i V;
+  static const size_t W = 4;
+  static V load(const int64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  static void store(int64_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+  static V set1(int64_t x) { return _mm256_set1_epi64x(x); }
+  static V zero() { return _mm256_setzero_si256(); }
+  static V add(V a, V b) { return _mm256_add_epi64(a, b); }
+  static V sub(V a, V b) { return _mm256_sub_epi64(a, b); }
+  static V mul(V a, V b)
+  {
+    const V lo = _mm256_mul_epu32(a, b);
+    const V cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+      _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+  }
+};
+
+#include "tsimd_kernels.h"
+}
+TMATRIX_END_TARGET
+
+// ---------------- AVX-512 ----------------
+TMATRIX_BEGIN_TARGET("avx512f,avx512dq")
+namespace tsimd_avx512
+{
+template<typename T> struct TOps;
+
+template<> struct TOps<float>
+{
+  typedef __m512 V;
+  static const size_t W = 16;
+  static V load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+  static V set1(float x) { return _mm512_set1_ps(x); }
+  static V zero() { return _mm512_setzero_ps(); }
+  static V add(V a, V b) { return _mm512_add_ps(a, b); }
+  static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+  static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+};
+template<> struct TOps<double>
+{
+  typedef __m512d V;
+  static const size_t W = 8;
+  static V load(const double* p) { return _mm512_loadu_pd(p); }
+  static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+  static V set1(double x) { return _mm512_set1_pd(x); }
+  static V zero() { return _mm512_setzero_pd(); }
+  static V add(V a, V b) { return _mm512_add_pd(a, b); }
+  static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+  static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+};
+template<> struct TOps<int32_t>
+{
+  typedef __m512i V;
+  static const size_t W = 16;
+  static V load(const int32_t* p) { return _mm512_loadu_si512(p); }
+  static void store(int32_t* p, V v) { _mm512_storeu_si512(p, v); }
+  static V set1(int32_t x) { return _mm512_set1_epi32(x); }
+  static V zero() { return _mm512_setzero_si512(); }
+  static V add(V a, V b) { return _mm512_add_epi32(a, b); }
+  static V sub(V a, V b) { return _mm512_sub_epi32(a, b); }
+  static V mul(V a, V b) { return _mm512_mullo_epi32(a, b); }
+};
+template<> struct TOps<int64_t>
+{
+  typedef __m512i V;
+  static const size_t W = 8;
+  static V load(const int64_t* p) { return _mm512_loadu_si512(p); }
+  static void store(int64_t* p, V v) { _mm512_storeu_si512(p, v); }
+  static V set1(int64_t x) { return _mm512_set1_epi64(x); }
+  static V zero() { return _mm512_setzero_si512(); }
+  static V add(V a, V b) { return _mm512_add_epi64(a, b); }
+  static V sub(V a, V b) { return _mm512_sub_epi64(a, b); }
+  static V mul(V a, V b) { return _mm512_mullo_epi64(a, b); }
+};
+
+#include "tsimd_kernels.h"
+}
+TMATRIX_END_TARGET
+#endif
+
+// Типы, для которых есть векторные ядра
+template<typename T>
+struct TSimdSupported
+{
+  static const bool value = std::is_same<T, float>::value || std::is_same<T, double>::value ||
+    std::is_same<T, int32_t>::value || std::is_same<T, int64_t>::value;
+};
+
+// Таблица ядер заданного уровня или nullptr, если уровень недоступен
+template<typename T>
+const TVecKernels<T>* vec_kernels_for(TSimdLevel level, std::true_type)
+{
+  if (level == SIMD_PORTABLE)
+    return &TVecKernelsPortable<T>::table();
+#ifdef TMATRIX_X86
+  const TCpuFeatures& f = cpu_features();
+  if (level == SIMD_SSE2 && f.sse2)
+    return &tsimd_sse2::TKernels<T>::table();
+  if (level == SIMD_AVX2 && f.avx2)
+    return &tsimd_avx2::TKernels<T>::table();
+  if (level == SIMD_AVX512 && f.avx512f && f.avx512dq)
+    return &tsimd_avx512::TKernels<T>::table();
+#endif
+  return nullptr;
+}
+template<typename T>
+const TVecKernels<T>* vec_kernels_for(TSimdLevel level, std::false_type)
+{
+  return level == SIMD_PORTABLE ? &TVecKernelsPortable<T>::table() : nullptr;
+}
+template<typename T>
+const TVecKernels<T>* vec_kernels_for(TSimdLevel level)
+{
+  return vec_kernels_for<T>(level, std::integral_constant<bool, TSimdSupported<T>::value>());
+}
+
+// Таблица ядер наилучшего доступного уровня, выбирается один раз
+template<typename T>
+const TVecKernels<T>& vec_kernels()
+{
+  static const TVecKernels<T>& k =
+    *vec_kernels_for<T>(TSimdSupported<T>::value ? cpu_features().level() : SIMD_PORTABLE);
+  return k;
+}
+
+#endif
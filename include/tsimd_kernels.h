@@ -0,0 +1,162 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Тела векторных ядер. Файл намеренно не имеет защиты от повторного
+// включения: tsimd.h включает его внутрь пространства имён каждого набора
+// инструкций, где уже определён шаблон TOps<T> с примитивами регистров
+
+template<typename T>
+void vec_add(const T* a, const T* b, T* c, size_t n)
+{
+  typedef TOps<T> O;
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+    O::store(c + i, O::add(O::load(a + i), O::load(b + i)));
+  for (; i < n; i++)
+    c[i] = a[i] + b[i];
+}
+
+template<typename T>
+void vec_sub(const T* a, const T* b, T* c, size_t n)
+{
+  typedef TOps<T> O;
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+    O::store(c + i, O::sub(O::load(a + i), O::load(b + i)));
+  for (; i < n; i++)
+    c[i] = a[i] - b[i];
+}
+
+template<typename T>
+void vec_add_scalar(const T* a, T val, T* c, size_t n)
+{
+  typedef TOps<T> O;
+  const typename O::V v = O::set1(val);
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+    O::store(c + i, O::add(O::load(a + i), v));
+  for (; i < n; i++)
+    c[i] = a[i] + val;
+}
+
+template<typename T>
+void vec_sub_scalar(const T* a, T val, T* c, size_t n)
+{
+  typedef TOps<T> O;
+  const typename O::V v = O::set1(val);
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+    O::store(c + i, O::sub(O::load(a + i), v));
+  for (; i < n; i++)
+    c[i] = a[i] - val;
+}
+
+template<typename T>
+void vec_mul_scalar(const T* a, T val, T* c, size_t n)
+{
+  typedef TOps<T> O;
+  const typename O::V v = O::set1(val);
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+    O::store(c + i, O::mul(O::load(a + i), v));
+  for (; i < n; i++)
+    c[i] = a[i] * val;
+}
+
+template<typename T>
+void vec_axpy(T alpha, const T* x, T* y, size_t n)
+{
+  typedef TOps<T> O;
+  const typename O::V v = O::set1(alpha);
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+    O::store(y + i, O::add(O::load(y + i), O::mul(v, O::load(x + i))));
+  for (; i < n; i++)
+    y[i] += alpha * x[i];
+}
+
+template<typename T>
+T vec_dot_block(const T* a, const T* b, size_t n)
+{
+  typedef TOps<T> O;
+  // четыре независимых аккумулятора скрывают задержку сложения
+  typename O::V acc0 = O::zero(), acc1 = O::zero(), acc2 = O::zero(), acc3 = O::zero();
+  size_t i = 0;
+  for (; i + 4 * O::W <= n; i += 4 * O::W)
+  {
+    acc0 = O::add(acc0, O::mul(O::load(a + i), O::load(b + i)));
+    acc1 = O::add(acc1, O::mul(O::load(a + i + O::W), O::load(b + i + O::W)));
+    acc2 = O::add(acc2, O::mul(O::load(a + i + 2 * O::W), O::load(b + i + 2 * O::W)));
+    acc3 = O::add(acc3, O::mul(O::load(a + i + 3 * O::W), O::load(b + i + 3 * O::W)));
+  }
+  for (; i + O::W <= n; i += O::W)
+    acc0 = O::add(acc0, O::mul(O::load(a + i), O::load(b + i)));
+  T lanes[O::W];
+  O::store(lanes, O::add(O::add(acc0, acc1), O::add(acc2, acc3)));
+  T res = T();
+  for (size_t l = 0; l < O::W; l++)
+    res += lanes[l];
+  for (; i < n; i++)
+    res += a[i] * b[i];
+  return res;
+}
+
+template<typename T>
+T vec_dot(const T* a, const T* b, size_t n)
+{
+  if (n <= DOT_BLOCK)
+    return vec_dot_block(a, b, n);
+  const size_t h = dot_pairwise_split(n);
+  return vec_dot(a, b, h) + vec_dot(a + h, b + h, n - h);
+}
+
+// Компенсированное произведение: в каждой полосе регистра ведётся сумма
+// Кэхэна, полосы и хвост затем складываются с компенсацией Ноймайера
+template<typename T>
+T vec_dot_compensated(const T* a, const T* b, size_t n, std::true_type)
+{
+  typedef TOps<T> O;
+  typename O::V s = O::zero(), c = O::zero();
+  size_t i = 0;
+  for (; i + O::W <= n; i += O::W)
+  {
+    const typename O::V y = O::sub(O::mul(O::load(a + i), O::load(b + i)), c);
+    const typename O::V t = O::add(s, y);
+    c = O::sub(O::sub(t, s), y);
+    s = t;
+  }
+  T ls[O::W], lc[O::W];
+  O::store(ls, s);
+  O::store(lc, c);
+  TNeumaierSum<T> sum;
+  for (size_t l = 0; l < O::W; l++)
+  {
+    sum.add(ls[l]);
+    sum.add(-lc[l]);
+  }
+  for (; i < n; i++)
+    sum.add(a[i] * b[i]);
+  return sum.result();
+}
+template<typename T>
+T vec_dot_compensated(const T* a, const T* b, size_t n, std::false_type)
+{
+  return vec_dot(a, b, n);
+}
+template<typename T>
+T vec_dot_compensated(const T* a, const T* b, size_t n)
+{
+  return vec_dot_compensated(a, b, n, std::is_floating_point<T>());
+}
+
+template<typename T>
+struct TKernels
+{
+  static const TVecKernels<T>& table()
+  {
+    static const TVecKernels<T> k = { &vec_add<T>, &vec_sub<T>, &vec_add_scalar<T>,
+      &vec_sub_scalar<T>, &vec_mul_scalar<T>, &vec_axpy<T>, &vec_dot<T>, &vec_dot_compensated<T> };
+    return k;
+  }
+};
@@ -0,0 +1,407 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Векторы и матрицы фиксированного размера.
+// Размер - параметр шаблона: объекты лежат на стеке без выделения памяти,
+// операции над объектами разного размера не компилируются
+
+#ifndef __TStaticMatrix_H__
+#define __TStaticMatrix_H__
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+
+// Наибольший размер, при котором циклы раскрываются полностью
+const size_t STATIC_UNROLL_MAX = 8;
+
+// Поэлементные операции
+struct TStaticAdd
+{
+  template<typename T>
+  static constexpr T apply(const T& a, const T& b) { return a + b; }
+};
+struct TStaticSub
+{
+  template<typename T>
+  static constexpr T apply(const T& a, const T& b) { return a - b; }
+};
+struct TStaticMul
+{
+  template<typename T>
+  static constexpr T apply(const T& a, const T& b) { return a * b; }
+};
+
+// Ядра над массивами из Count элементов: при Unroll тело раскрывается
+// на этапе компиляции в Count независимых выражений, иначе - обычный цикл
+template<typename T, size_t Count, bool Unroll>
+struct TStaticKernels;
+
+template<typename T, size_t Count>
+struct TStaticKernels<T, Count, true>
+{
+  typedef std::make_index_sequence<Count> Seq;
+
+  template<typename Op, size_t... I>
+  static constexpr void map(const T* a, const T* b, T* c, std::index_sequence<I...>)
+  {
+    int u[] = { 0, (c[I] = Op::apply(a[I], b[I]), 0)... };
+    (void)u;
+  }
+  template<typename Op, size_t... I>
+  static constexpr void map_scalar(const T* a, const T& val, T* c, std::index_sequence<I...>)
+  {
+    int u[] = { 0, (c[I] = Op::apply(a[I], val), 0)... };
+    (void)u;
+  }
+  // сумма a[k] * b[k * stride]
+  template<size_t... I>
+  static constexpr T dot(const T* a, const T* b, size_t stride, std::index_sequence<I...>)
+  {
+    T s = T();
+    int u[] = { 0, (s += a[I] * b[I * stride], 0)... };
+    (void)u;
+    return s;
+  }
+  template<size_t... I>
+  static constexpr bool equal(const T* a, const T* b, std::index_sequence<I...>)
+  {
+    bool eq = true;
+    int u[] = { 0, (eq = eq && a[I] == b[I], 0)... };
+    (void)u;
+    return eq;
+  }
+
+  template<typename Op>
+  static constexpr void map(const T* a, const T* b, T* c) { map<Op>(a, b, c, Seq()); }
+  template<typename Op>
+  static constexpr void map_scalar(const T* a, const T& val, T* c) { map_scalar<Op>(a, val, c, Seq()); }
+  static constexpr T dot(const T* a, const T* b, size_t stride = 1) { return dot(a, b, stride, Seq()); }
+  static constexpr bool equal(const T* a, const T* b) { return equal(a, b, Seq()); }
+};
+
+template<typename T, size_t Count>
+struct TStaticKernels<T, Count, false>
+{
+  template<typename Op>
+  static constexpr void map(const T* a, const T* b, T* c)
+  {
+    for (size_t i = 0; i < Count; i++)
+      c[i] = Op::apply(a[i], b[i]);
+  }
+  template<typename Op>
+  static constexpr void map_scalar(const T* a, const T& val, T* c)
+  {
+    for (size_t i = 0; i < Count; i++)
+      c[i] = Op::apply(a[i], val);
+  }
+  static constexpr T dot(const T* a, const T* b, size_t stride = 1)
+  {
+    T s = T();
+    for (size_t i = 0; i < Count; i++)
+      s += a[i] * b[i * stride];
+    return s;
+  }
+  static constexpr bool equal(const T* a, const T* b)
+  {
+    for (size_t i = 0; i < Count; i++)
+      if (a[i] != b[i])
+        return false;
+    return true;
+  }
+};
+
+// Вектор фиксированного размера
+template<typename T, size_t N>
+class TStaticVector
+{
+  static_assert(N > 0, "Vector size should be greater than zero");
+  typedef TStaticKernels<T, N, (N <= STATIC_UNROLL_MAX)> K;
+
+  T mem[N];
+public:
+  typedef T value_type;
+
+  constexpr TStaticVector() : mem{} {}
+  // перечисление элементов, недостающие элементы нулевые
+  template<typename... Args>
+  constexpr explicit TStaticVector(const T& first, const Args&... rest) : mem{ first, T(rest)... }
+  {
+    static_assert(sizeof...(Args) < N, "Too many initializers for TStaticVector");
+  }
+
+  static constexpr size_t size() noexcept { return N; }
+  constexpr T* data() noexcept { return mem; }
+  constexpr const T* data() const noexcept { return mem; }
+
+  // индексация
+  constexpr T& operator[](size_t ind) { return mem[ind]; }
+  constexpr const T& operator[](size_t ind) const { return mem[ind]; }
+  // индексация с контролем
+  constexpr T& at(size_t ind)
+  {
+    if (ind >= N)
+      throw std::out_of_range("Vector index is out of range");
+    return mem[ind];
+  }
+  constexpr const T& at(size_t ind) const
+  {
+    if (ind >= N)
+      throw std::out_of_range("Vector index is out of range");
+    return mem[ind];
+  }
+  // индекс, проверяемый при компиляции
+  template<size_t I>
+  constexpr T& get() noexcept
+  {
+    static_assert(I < N, "Vector index is out of range");
+    return mem[I];
+  }
+  template<size_t I>
+  constexpr const T& get() const noexcept
+  {
+    static_assert(I < N, "Vector index is out of range");
+    return mem[I];
+  }
+
+  // сравнение
+  constexpr bool operator==(const TStaticVector& v) const noexcept
+  {
+    return K::equal(mem, v.mem);
+  }
+  constexpr bool operator!=(const TStaticVector& v) const noexcept
+  {
+    return !(*this == v);
+  }
+
+  // скалярные операции
+  constexpr TStaticVector& operator+=(const T& val)
+  {
+    K::template map_scalar<TStaticAdd>(mem, val, mem);
+    return *this;
+  }
+  constexpr TStaticVector& operator-=(const T& val)
+  {
+    K::template map_scalar<TStaticSub>(mem, val, mem);
+    return *this;
+  }
+  constexpr TStaticVector& operator*=(const T& val)
+  {
+    K::template map_scalar<TStaticMul>(mem, val, mem);
+    return *this;
+  }
+  constexpr TStaticVector operator+(const T& val) const
+  {
+    TStaticVector res;
+    K::template map_scalar<TStaticAdd>(mem, val, res.mem);
+    return res;
+  }
+  constexpr TStaticVector operator-(const T& val) const
+  {
+    TStaticVector res;
+    K::template map_scalar<TStaticSub>(mem, val, res.mem);
+    return res;
+  }
+  constexpr TStaticVector operator*(const T& val) const
+  {
+    TStaticVector res;
+    K::template map_scalar<TStaticMul>(mem, val, res.mem);
+    return res;
+  }
+
+  // векторные операции
+  constexpr TStaticVector& operator+=(const TStaticVector& v)
+  {
+    K::template map<TStaticAdd>(mem, v.mem, mem);
+    return *this;
+  }
+  constexpr TStaticVector& operator-=(const TStaticVector& v)
+  {
+    K::template map<TStaticSub>(mem, v.mem, mem);
+    return *this;
+  }
+  constexpr TStaticVector operator+(const TStaticVector& v) const
+  {
+    TStaticVector res;
+    K::template map<TStaticAdd>(mem, v.mem, res.mem);
+    return res;
+  }
+  constexpr TStaticVector operator-(const TStaticVector& v) const
+  {
+    TStaticVector res;
+    K::template map<TStaticSub>(mem, v.mem, res.mem);
+    return res;
+  }
+  constexpr T operator*(const TStaticVector& v) const
+  {
+    return K::dot(mem, v.mem);
+  }
+
+  // ввод/вывод
+  friend std::istream& operator>>(std::istream& istr, TStaticVector& v)
+  {
+    for (size_t i = 0; i < N; i++)
+      istr >> v.mem[i];
+    return istr;
+  }
+  friend std::ostream& operator<<(std::ostream& ostr, const TStaticVector& v)
+  {
+    for (size_t i = 0; i < N; i++)
+      ostr << v.mem[i] << ' ';
+    return ostr;
+  }
+};
+
+// Матрица фиксированного размера N x N -
+// элементы хранятся построчно в массиве из N*N элементов,
+// operator[] возвращает указатель на начало строки
+template<typename T, size_t N>
+class TStaticMatrix
+{
+  static_assert(N > 0, "Matrix size should be greater than zero");
+  static const bool Unroll = N <= STATIC_UNROLL_MAX;
+  typedef TStaticKernels<T, N * N, Unroll> K;
+  typedef TStaticKernels<T, N, Unroll> KRow;
+
+  T mem[N * N];
+public:
+  typedef T value_type;
+
+  constexpr TStaticMatrix() : mem{} {}
+
+  // единичная матрица
+  static constexpr TStaticMatrix identity()
+  {
+    TStaticMatrix res;
+    for (size_t i = 0; i < N; i++)
+      res.mem[i * N + i] = T(1);
+    return res;
+  }
+
+  static constexpr size_t size() noexcept { return N; }
+  constexpr T* data() noexcept { return mem; }
+  constexpr const T* data() const noexcept { return mem; }
+
+  // индексация: m[i][j]
+  constexpr T* operator[](size_t ind) { return mem + ind * N; }
+  constexpr const T* operator[](size_t ind) const { return mem + ind * N; }
+  constexpr T& operator()(size_t i, size_t j) { return mem[i * N + j]; }
+  constexpr const T& operator()(size_t i, size_t j) const { return mem[i * N + j]; }
+  // индексация с контролем
+  constexpr T& at(size_t i, size_t j)
+  {
+    if (i >= N || j >= N)
+      throw std::out_of_range("Matrix index is out of range");
+    return mem[i * N + j];
+  }
+  constexpr const T& at(size_t i, size_t j) const
+  {
+    if (i >= N || j >= N)
+      throw std::out_of_range("Matrix index is out of range");
+    return mem[i * N + j];
+  }
+  // индексы, проверяемые при компиляции
+  template<size_t I, size_t J>
+  constexpr T& get() noexcept
+  {
+    static_assert(I < N && J < N, "Matrix index is out of range");
+    return mem[I * N + J];
+  }
+  template<size_t I, size_t J>
+  constexpr const T& get() const noexcept
+  {
+    static_assert(I < N && J < N, "Matrix index is out of range");
+    return mem[I * N + J];
+  }
+
+  // сравнение
+  constexpr bool operator==(const TStaticMatrix& m) const noexcept
+  {
+    return K::equal(mem, m.mem);
+  }
+  constexpr bool operator!=(const TStaticMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+
+  // матрично-скалярные операции
+  constexpr TStaticMatrix& operator*=(const T& val)
+  {
+    K::template map_scalar<TStaticMul>(mem, val, mem);
+    return *this;
+  }
+  constexpr TStaticMatrix operator*(const T& val) const
+  {
+    TStaticMatrix res;
+    K::template map_scalar<TStaticMul>(mem, val, res.mem);
+    return res;
+  }
+
+  // матрично-векторные операции
+  constexpr TStaticVector<T, N> operator*(const TStaticVector<T, N>& v) const
+  {
+    TStaticVector<T, N> res;
+    for (size_t i = 0; i < N; i++)
+      res[i] = KRow::dot(mem + i * N, v.data());
+    return res;
+  }
+
+  // матрично-матричные операции
+  constexpr TStaticMatrix& operator+=(const TStaticMatrix& m)
+  {
+    K::template map<TStaticAdd>(mem, m.mem, mem);
+    return *this;
+  }
+  constexpr TStaticMatrix& operator-=(const TStaticMatrix& m)
+  {
+    K::template map<TStaticSub>(mem, m.mem, mem);
+    return *this;
+  }
+  constexpr TStaticMatrix& operator*=(const TStaticMatrix& m)
+  {
+    return *this = *this * m;
+  }
+  constexpr TStaticMatrix operator+(const TStaticMatrix& m) const
+  {
+    TStaticMatrix res;
+    K::template map<TStaticAdd>(mem, m.mem, res.mem);
+    return res;
+  }
+  constexpr TStaticMatrix operator-(const TStaticMatrix& m) const
+  {
+    TStaticMatrix res;
+    K::template map<TStaticSub>(mem, m.mem, res.mem);
+    return res;
+  }
+  // c[i][j] - произведение строки i на столбец j (шаг столбца N)
+  constexpr TStaticMatrix operator*(const TStaticMatrix& m) const
+  {
+    TStaticMatrix res;
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        res.mem[i * N + j] = KRow::dot(mem + i * N, m.mem + j, N);
+    return res;
+  }
+
+  // ввод/вывод
+  friend std::istream& operator>>(std::istream& istr, TStaticMatrix& m)
+  {
+    for (size_t i = 0; i < N * N; i++)
+      istr >> m.mem[i];
+    return istr;
+  }
+  friend std::ostream& operator<<(std::ostream& ostr, const TStaticMatrix& m)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      for (size_t j = 0; j < N; j++)
+        ostr << m.mem[i * N + j] << ' ';
+      ostr << std::endl;
+    }
+    return ostr;
+  }
+};
+
+#endif
@@ -0,0 +1,294 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Верхнетреугольная матрица в упакованном виде
+
+#ifndef __TUpperTriangularMatrix_H__
+#define __TUpperTriangularMatrix_H__
+
+#include "tmatrix.h"
+
+// Ссылка на элемент строки верхнетреугольной матрицы:
+// под диагональю читается T(), запись туда бросает исключение
+template<typename T>
+class TTriangularRef
+{
+  T* p;
+public:
+  typedef typename std::remove_const<T>::type value_type;
+
+  explicit TTriangularRef(T* ptr) noexcept : p(ptr) {}
+  TTriangularRef(const TTriangularRef& r) = default;
+
+  operator value_type() const { return p ? *p : value_type(); }
+  TTriangularRef& operator=(const value_type& val)
+  {
+    if (p == nullptr)
+      throw out_of_range("Elements below the diagonal are not stored");
+    *p = val;
+    return *this;
+  }
+  TTriangularRef& operator=(const TTriangularRef& r)
+  {
+    return *this = value_type(r);
+  }
+};
+
+// Строка i верхнетреугольной матрицы - представление столбцов 0..n-1,
+// из которых хранятся только i..n-1
+template<typename T>
+class TTriangularRow
+{
+  T* pRow;
+  size_t row;
+  size_t sz;
+public:
+  typedef typename std::remove_const<T>::type value_type;
+
+  // p - хранимый элемент (i, i)
+  TTriangularRow(T* p, size_t i, size_t size) noexcept : pRow(p), row(i), sz(size) {}
+  TTriangularRow(const TTriangularRow& r) = default;
+
+  // присваивание вектора: элементы под диагональю должны быть нулевыми
+  TTriangularRow& operator=(const TDynamicVector<value_type>& v)
+  {
+    if (sz != v.size())
+      throw length_error("Row and vector should have equal size");
+    for (size_t j = 0; j < row; j++)
+      if (!(v[j] == value_type()))
+        throw out_of_range("Elements below the diagonal are not stored");
+    for (size_t j = row; j < sz; j++)
+      pRow[j - row] = v[j];
+    return *this;
+  }
+
+  size_t size() const noexcept { return sz; }
+
+  // индексация
+  TTriangularRef<T> operator[](size_t ind) const noexcept
+  {
+    return TTriangularRef<T>(ind < row ? nullptr : pRow + ind - row);
+  }
+  // индексация с контролем
+  TTriangularRef<T> at(size_t ind) const
+  {
+    if (ind >= sz)
+      throw out_of_range("Row index is out of range");
+    return (*this)[ind];
+  }
+};
+
+// Верхнетреугольная матрица -
+// хранит только элементы на и над главной диагональю, n(n+1)/2 штук.
+// Строка i упакована с позиции offset(i) и содержит элементы i..n-1,
+// элементы под диагональю считаются нулевыми и не хранятся
+template<typename T>
+class TUpperTriangularMatrix : private TDynamicVector<T>
+{
+  using TDynamicVector<T>::pMem;
+  size_t sz;
+
+  static size_t checked_size(size_t s)
+  {
+    if (s == 0)
+      throw out_of_range("Matrix size should be greater than zero");
+    if (s > MAX_MATRIX_SIZE)
+      throw out_of_range("Matrix size should not exceed MAX_MATRIX_SIZE");
+    return s;
+  }
+  static size_t packed_size(size_t s) noexcept { return s * (s + 1) / 2; }
+  TUpperTriangularMatrix(TDynamicVector<T>&& v, size_t s) noexcept : TDynamicVector<T>(std::move(v)), sz(s) {}
+  const TDynamicVector<T>& elems() const noexcept { return *this; }
+public:
+  TUpperTriangularMatrix(size_t s = 1) : TDynamicVector<T>(packed_size(checked_size(s))), sz(s) {}
+  TUpperTriangularMatrix(const TUpperTriangularMatrix& m) = default;
+  TUpperTriangularMatrix(TUpperTriangularMatrix&& m) noexcept : TDynamicVector<T>(std::move(m)), sz(m.sz)
+  {
+    m.sz = 0;
+  }
+  TUpperTriangularMatrix& operator=(const TUpperTriangularMatrix& m) = default;
+  TUpperTriangularMatrix& operator=(TUpperTriangularMatrix&& m) noexcept
+  {
+    swap(*this, m);
+    return *this;
+  }
+
+  size_t size() const noexcept { return sz; }
+  // число хранимых элементов
+  size_t packed_size() const noexcept { return packed_size(sz); }
+
+  // позиция первого хранимого элемента строки i
+  size_t offset(size_t i) const noexcept { return i * sz - i * (i - 1) / 2; }
+
+  // индексация: элементы строки под диагональю читаются как T(),
+  // запись в них бросает исключение
+  TTriangularRow<T> operator[](size_t ind) noexcept
+  {
+    return TTriangularRow<T>(pMem + offset(ind), ind, sz);
+  }
+  TTriangularRow<const T> operator[](size_t ind) const noexcept
+  {
+    return TTriangularRow<const T>(pMem + offset(ind), ind, sz);
+  }
+  // индексация с контролем
+  T& at(size_t i, size_t j)
+  {
+    if (i >= sz || j >= sz)
+      throw out_of_range("Matrix index is out of range");
+    if (j < i)
+      throw out_of_range("Elements below the diagonal are not stored");
+    return pMem[offset(i) + j - i];
+  }
+  // значение элемента с учётом нулевого нижнего треугольника
+  T get(size_t i, size_t j) const
+  {
+    if (i >= sz || j >= sz)
+      throw out_of_range("Matrix index is out of range");
+    return j < i ? T() : pMem[offset(i) + j - i];
+  }
+
+  // сравнение
+  bool operator==(const TUpperTriangularMatrix& m) const noexcept
+  {
+    return sz == m.sz && elems() == m.elems();
+  }
+  bool operator!=(const TUpperTriangularMatrix& m) const noexcept
+  {
+    return !(*this == m);
+  }
+
+  // матрично-скалярные операции
+  TUpperTriangularMatrix operator*(const T& val) const
+  {
+    return TUpperTriangularMatrix(elems() * val, sz);
+  }
+
+  // матрично-векторные операции
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+  {
+    if (sz != v.size())
+      throw length_error("Matrix and vector should have equal size");
+    TDynamicVector<T> res(sz, UNINITIALIZED);
+    const T* row = pMem;
+    for (size_t i = 0; i < sz; i++)
+    {
+      T s = T();
+      for (size_t j = i; j < sz; j++)
+        s += row[j - i] * v[j];
+      res[i] = s;
+      row += sz - i;
+    }
+    return res;
+  }
+
+  // матрично-матричные операции
+  TUpperTriangularMatrix operator+(const TUpperTriangularMatrix& m) const
+  {
+    if (sz != m.sz)
+      throw length_error("Matrices should have equal size");
+    return TUpperTriangularMatrix(elems() + m.elems(), sz);
+  }
+  TUpperTriangularMatrix operator-(const TUpperTriangularMatrix& m) const
+  {
+    if (sz != m.sz)
+      throw length_error("Matrices should have equal size");
+    return TUpperTriangularMatrix(elems() - m.elems(), sz);
+  }
+  // произведение верхнетреугольных матриц верхнетреугольно:
+  // c[i][j] = sum(a[i][k] * b[k][j], k = i..j), около n^3/6 умножений
+  TUpperTriangularMatrix operator*(const TUpperTriangularMatrix& m) const
+  {
+    if (sz != m.sz)
+      throw length_error("Matrices should have equal size");
+    TUpperTriangularMatrix res(sz);
+    for (size_t i = 0; i < sz; i++)
+    {
+      const T* a = pMem + offset(i) - i;
+      T* c = res.pMem + offset(i) - i;
+      for (size_t k = i; k < sz; k++)
+      {
+        const T aik = a[k];
+        const T* b = m.pMem + m.offset(k) - k;
+        for (size_t j = k; j < sz; j++)
+          c[j] += aik * b[j];
+      }
+    }
+    return res;
+  }
+  // верхнетреугольная на плотную n x p: нулевые a[i][k] при k < i пропускаются
+  TDynamicMatrix<T> operator*(const TDynamicMatrix<T>& m) const
+  {
+    if (sz != m.rows())
+      throw length_error("Matrix sizes do not match");
+    const size_t p = m.cols();
+    TDynamicMatrix<T> res(sz, p);
+    for (size_t i = 0; i < sz; i++)
+    {
+      const T* a = pMem + offset(i) - i;
+      T* c = res[i].data();
+      for (size_t k = i; k < sz; k++)
+      {
+        const T aik = a[k];
+        const T* b = m[k].data();
+        for (size_t j = 0; j < p; j++)
+          c[j] += aik * b[j];
+      }
+    }
+    return res;
+  }
+  // плотная p x n на верхнетреугольную: нулевые b[k][j] при j < k пропускаются
+  friend TDynamicMatrix<T> operator*(const TDynamicMatrix<T>& m, const TUpperTriangularMatrix& u)
+  {
+    if (m.cols() != u.sz)
+      throw length_error("Matrix sizes do not match");
+    const size_t n = u.sz;
+    TDynamicMatrix<T> res(m.rows(), n);
+    for (size_t i = 0; i < m.rows(); i++)
+    {
+      const T* a = m[i].data();
+      T* c = res[i].data();
+      for (size_t k = 0; k < n; k++)
+      {
+        const T aik = a[k];
+        const T* b = u.pMem + u.offset(k) - k;
+        for (size_t j = k; j < n; j++)
+          c[j] += aik * b[j];
+      }
+    }
+    return res;
+  }
+
+  // плотная копия
+  TDynamicMatrix<T> dense() const
+  {
+    TDynamicMatrix<T> res(sz);
+    for (size_t i = 0; i < sz; i++)
+      std::copy(pMem + offset(i), pMem + offset(i) + sz - i, &res[i][i]);
+    return res;
+  }
+
+  friend void swap(TUpperTriangularMatrix& lhs, TUpperTriangularMatrix& rhs) noexcept
+  {
+    swap(static_cast<TDynamicVector<T>&>(lhs), static_cast<TDynamicVector<T>&>(rhs));
+    std::swap(lhs.sz, rhs.sz);
+  }
+
+  // ввод/вывод: вводятся только элементы верхнего треугольника по строкам
+  friend istream& operator>>(istream& istr, TUpperTriangularMatrix& v)
+  {
+    return istr >> static_cast<TDynamicVector<T>&>(v);
+  }
+  friend ostream& operator<<(ostream& ostr, const TUpperTriangularMatrix& v)
+  {
+    for (size_t i = 0; i < v.sz; i++)
+    {
+      for (size_t j = 0; j < v.sz; j++)
+        ostr << v.get(i, j) << ' ';
+      ostr << endl;
+    }
+    return ostr;
+  }
+};
+
+#endif
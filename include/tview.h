@@ -0,0 +1,390 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Copyright (c) Сысоев А.В.
+//
+// Представления векторов и матриц над чужой памятью.
+// Представление не владеет элементами и не копирует их: внешний массив,
+// сегмент общей памяти или память вектора/матрицы используются на месте.
+// Представления участвуют в выражениях, операциях с присваиванием и
+// функциях scal, axpy, dot, gemv, gemm наравне с векторами и матрицами
+
+#ifndef __TView_H__
+#define __TView_H__
+
+#include "tmatrix.h"
+
+// Представление вектора -
+// sz элементов с шагом step: элемент i лежит в data()[i * inc()].
+// Для представления только для чтения T - константный тип
+template<typename T>
+class TVectorView
+{
+  T* pMem;
+  size_t sz;
+  size_t step;
+
+  template<typename E>
+  TVectorView& assign(const E& e)
+  {
+    if (sz != e.size())
+      throw length_error("View and vector should have equal size");
+    if (step == 1)
+      expr_assign(pMem, e);
+    else
+      for (size_t i = 0; i < sz; i++)
+        pMem[i * step] = e[i];
+    return *this;
+  }
+public:
+  typedef TVecExprTag expr_category;
+  typedef typename std::remove_const<T>::type value_type;
+
+  TVectorView(T* p, size_t size, size_t inc = 1) noexcept : pMem(p), sz(size), step(inc) {}
+  // представление всего вектора или строки матрицы
+  template<typename V, typename = typename std::enable_if<TIsVecExpr<typename std::remove_const<V>::type>::value &&
+    TIsContiguous<typename std::remove_const<V>::type>::value &&
+    std::is_convertible<decltype(std::declval<V&>().data()), T*>::value>::type>
+  TVectorView(V& v) noexcept : pMem(v.data()), sz(v.size()), step(1) {}
+  template<typename U>
+  TVectorView(const TMatrixRow<U>& r) noexcept : pMem(r.data()), sz(r.size()), step(1) {}
+  // представление только для чтения из изменяемого
+  template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+  TVectorView(const TVectorView<U>& v) noexcept : pMem(v.data()), sz(v.size()), step(v.inc()) {}
+  TVectorView(const TVectorView& v) = default;
+
+  // присваивание копирует элементы, а не перенаправляет представление.
+  // Представление-приёмник не должно пересекаться с операндами со сдвигом
+  TVectorView& operator=(const TVectorView& v)
+  {
+    return assign(v);
+  }
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TVectorView&>::type operator=(const E& e)
+  {
+    return assign(e);
+  }
+
+  // операции с присваиванием выполняются в памяти представления
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TVectorView&>::type operator+=(const E& e)
+  {
+    return assign(TVecBinary<TVectorView, E, TOpAdd>(*this, e));
+  }
+  template<typename E>
+  typename std::enable_if<TIsVecExpr<E>::value, TVectorView&>::type operator-=(const E& e)
+  {
+    return assign(TVecBinary<TVectorView, E, TOpSub>(*this, e));
+  }
+  TVectorView& operator+=(const value_type& val)
+  {
+    return assign(TVecScalar<TVectorView, TOpAdd>(*this, val));
+  }
+  TVectorView& operator-=(const value_type& val)
+  {
+    return assign(TVecScalar<TVectorView, TOpSub>(*this, val));
+  }
+  TVectorView& operator*=(const value_type& val)
+  {
+    scal(val, *this);
+    return *this;
+  }
+
+  size_t size() const noexcept { return sz; }
+  // шаг элементов в памяти
+  size_t inc() const noexcept { return step; }
+  T* data() const noexcept { return pMem; }
+
+  // индексация
+  T& operator[](size_t ind) const
+  {
+    return pMem[ind * step];
+  }
+  // индексация с контролем
+  T& at(size_t ind) const
+  {
+    if (ind >= sz)
+      throw out_of_range("View index is out of range");
+    return pMem[ind * step];
+  }
+
+  friend ostream& operator<<(ostream& ostr, const TVectorView& v)
+  {
+    for (size_t i = 0; i < v.sz; i++)
+      ostr << v[i] << ' ';
+    return ostr;
+  }
+};
+
+template<typename T>
+struct TIsStrided<TVectorView<T>> : std::true_type {};
+
+// Пересекается ли операнд выражения с памятью m x n с шагом строк ld,
+// начинающейся с p, иначе чем поэлементно на месте. Такой операнд
+// затирается при вычислении выражения построчно
+template<typename T, typename E>
+typename std::enable_if<!TIsContiguous<E>::value, bool>::type
+expr_aliases(const T*, size_t, size_t, size_t, const E&) noexcept
+{
+  return false;
+}
+template<typename T, typename E>
+typename std::enable_if<TIsContiguous<E>::value, bool>::type
+expr_aliases(const T* p, size_t m, size_t n, size_t ld, const E& e) noexcept
+{
+  const void* q = e.data();
+  if (q == p && e.stride() == ld)
+    return false;
+  return mem_overlap(reinterpret_cast<const char*>(p), ((m - 1) * ld + n) * sizeof(T),
+    reinterpret_cast<const char*>(q), ((e.rows() - 1) * e.stride() + e.cols()) * sizeof(typename E::value_type));
+}
+template<typename T, typename L, typename R, typename Op>
+bool expr_aliases(const T* p, size_t m, size_t n, size_t ld, const TMatBinary<L, R, Op>& e) noexcept
+{
+  return expr_aliases(p, m, n, ld, e.left()) || expr_aliases(p, m, n, ld, e.right());
+}
+template<typename T, typename E, typename Op>
+bool expr_aliases(const T* p, size_t m, size_t n, size_t ld, const TMatScalar<E, Op>& e) noexcept
+{
+  return expr_aliases(p, m, n, ld, e.expr());
+}
+
+// Представление матрицы -
+// m x n элементов, строка i начинается с data() + i * stride().
+// Блок, столбец и диагональ представления тоже являются представлениями
+// той же памяти
+template<typename T>
+class TMatrixView
+{
+  T* pMem;
+  size_t m;
+  size_t n;
+  size_t ld;
+
+  // представление только для чтения берёт память через константный data()
+  template<typename M>
+  static T* data_of(M& a, std::true_type) { return static_cast<const M&>(a).data(); }
+  template<typename M>
+  static T* data_of(M& a, std::false_type) { return a.data(); }
+
+  // выражение с операндом, пересекающим представление со сдвигом,
+  // вычисляется через временную матрицу
+  template<typename E>
+  TMatrixView& assign(const E& e)
+  {
+    if (expr_aliases(pMem, m, n, ld, e))
+      expr_assign_matrix(pMem, ld, TDynamicMatrix<value_type>(e));
+    else
+      expr_assign_matrix(pMem, ld, e);
+    return *this;
+  }
+public:
+  typedef TMatExprTag expr_category;
+  typedef typename std::remove_const<T>::type value_type;
+
+  TMatrixView(T* p, size_t rows, size_t cols, size_t stride) noexcept : pMem(p), m(rows), n(cols), ld(stride) {}
+  TMatrixView(T* p, size_t size, size_t stride) noexcept : pMem(p), m(size), n(size), ld(stride) {}
+  TMatrixView(T* p, size_t size) noexcept : pMem(p), m(size), n(size), ld(size) {}
+  // представление всей матрицы
+  template<typename M, typename = typename std::enable_if<TIsMatExpr<typename std::remove_const<M>::type>::value &&
+    TIsContiguous<typename std::remove_const<M>::type>::value &&
+    std::is_convertible<decltype(std::declval<M&>().data()), T*>::value>::type>
+  TMatrixView(M& a) : pMem(data_of(a, std::is_const<T>())), m(a.rows()), n(a.cols()), ld(a.stride()) {}
+  template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+  TMatrixView(const TMatrixView<U>& a) noexcept : pMem(a.data()), m(a.rows()), n(a.cols()), ld(a.stride()) {}
+  TMatrixView(const TMatrixView& a) = default;
+
+  // присваивание копирует элементы, произведение вычисляется ядром
+  // умножения прямо в память представления. Операнды могут пересекаться
+  // с представлением, например m.block(1, 1, 3, 3) = m.block(0, 0, 3, 3)
+  TMatrixView& operator=(const TMatrixView& a)
+  {
+    if (m != a.m || n != a.n)
+      throw length_error("Views should have equal size");
+    expr_assign_matrix(pMem, ld, a);
+    return *this;
+  }
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TMatrixView&>::type operator=(const E& e)
+  {
+    if (m != e.rows() || n != e.cols())
+      throw length_error("View and matrix should have equal size");
+    return assign(e);
+  }
+
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TMatrixView&>::type operator+=(const E& e)
+  {
+    if (expr_aliases(pMem, m, n, ld, e))
+      expr_add_assign_matrix(pMem, ld, *this, TDynamicMatrix<value_type>(e));
+    else
+      expr_add_assign_matrix(pMem, ld, *this, e);
+    return *this;
+  }
+  template<typename E>
+  typename std::enable_if<TIsMatExpr<E>::value, TMatrixView&>::type operator-=(const E& e)
+  {
+    return assign(TMatBinary<TMatrixView, E, TOpSub>(*this, e));
+  }
+  TMatrixView& operator*=(const value_type& val)
+  {
+    scal(val, *this);
+    return *this;
+  }
+
+  size_t rows() const noexcept { return m; }
+  size_t cols() const noexcept { return n; }
+  size_t stride() const noexcept { return ld; }
+  T* data() const noexcept { return pMem; }
+
+  // индексация
+  TMatrixRow<T> operator[](size_t ind) const noexcept
+  {
+    return TMatrixRow<T>(pMem + ind * ld, n);
+  }
+  // индексация с контролем
+  TMatrixRow<T> at(size_t ind) const
+  {
+    if (ind >= m)
+      throw out_of_range("View index is out of range");
+    return (*this)[ind];
+  }
+  // элемент для вычисления выражений
+  const value_type& operator()(size_t i, size_t j) const noexcept
+  {
+    return pMem[i * ld + j];
+  }
+
+  // блок rows x cols с углом (r0, c0)
+  TMatrixView block(size_t r0, size_t c0, size_t rows, size_t cols) const
+  {
+    if (rows == 0 || cols == 0 || r0 > m || c0 > n || rows > m - r0 || cols > n - c0)
+      throw out_of_range("Block is out of range");
+    return TMatrixView(pMem + r0 * ld + c0, rows, cols, ld);
+  }
+  TMatrixRow<T> row(size_t i) const
+  {
+    return at(i);
+  }
+  // столбец: элементы с шагом stride()
+  TVectorView<T> col(size_t j) const
+  {
+    if (j >= n)
+      throw out_of_range("View index is out of range");
+    return TVectorView<T>(pMem + j, m, ld);
+  }
+  // главная диагональ: элементы с шагом stride() + 1
+  TVectorView<T> diag() const noexcept
+  {
+    return TVectorView<T>(pMem, std::min(m, n), ld + 1);
+  }
+
+  friend ostream& operator<<(ostream& ostr, const TMatrixView& a)
+  {
+    for (size_t i = 0; i < a.m; i++)
+    {
+      for (size_t j = 0; j < a.n; j++)
+        ostr << a(i, j) << ' ';
+      ostr << endl;
+    }
+    return ostr;
+  }
+};
+
+template<typename T>
+struct TIsContiguous<TMatrixView<T>> : std::true_type {};
+
+// Признак представления: сравнение с ним не копирует элементы
+template<typename E>
+struct TIsView : std::false_type {};
+template<typename T>
+struct TIsView<TVectorView<T>> : std::true_type {};
+template<typename T>
+struct TIsView<TMatrixView<T>> : std::true_type {};
+
+// Копирование из представления в непрерывную память
+template<typename T, typename U>
+void expr_assign(T* dst, const TVectorView<U>& v)
+{
+  if (v.inc() == 1)
+    std::copy(v.data(), v.data() + v.size(), dst);
+  else
+    expr_loop(dst, v);
+}
+// Если память пересекается при том же шаге строк, строки копируются
+// в порядке, при котором источник не затирается до чтения: с конца,
+// когда приёмник лежит дальше источника. При разных шагах строк
+// источник сначала копируется во временный буфер
+template<typename T, typename U>
+void expr_assign_matrix(T* dst, size_t ld, const TMatrixView<U>& m)
+{
+  const size_t rows = m.rows(), cols = m.cols(), st = m.stride();
+  const U* src = m.data();
+  const char* p = reinterpret_cast<const char*>(dst);
+  const char* q = reinterpret_cast<const char*>(src);
+  const bool overlap = mem_overlap(p, ((rows - 1) * ld + cols) * sizeof(T), q, ((rows - 1) * st + cols) * sizeof(U));
+  if (overlap && st == ld && std::less<const char*>()(q, p))
+    for (size_t i = rows; i-- > 0;)
+      std::copy_backward(src + i * st, src + i * st + cols, dst + i * ld + cols);
+  else if (!overlap || st == ld)
+    for (size_t i = 0; i < rows; i++)
+      std::copy(src + i * st, src + i * st + cols, dst + i * ld);
+  else
+  {
+    TDynamicVector<typename TMatrixView<U>::value_type> tmp(rows * cols);
+    for (size_t i = 0; i < rows; i++)
+      std::copy(src + i * st, src + i * st + cols, tmp.data() + i * cols);
+    for (size_t i = 0; i < rows; i++)
+      std::copy(tmp.data() + i * cols, tmp.data() + (i + 1) * cols, dst + i * ld);
+  }
+}
+
+// операнды умножения используются без копирования
+template<typename T>
+const TVectorView<T>& materialize(const TVectorView<T>& v) noexcept
+{
+  return v;
+}
+template<typename T>
+const TMatrixView<T>& materialize(const TMatrixView<T>& m) noexcept
+{
+  return m;
+}
+
+// сравнение представлений с векторами, матрицами и друг с другом
+template<typename L, typename R>
+typename std::enable_if<TIsVecExpr<L>::value && TIsVecExpr<R>::value &&
+  (TIsView<L>::value || TIsView<R>::value), bool>::type
+operator==(const L& l, const R& r)
+{
+  if (l.size() != r.size())
+    return false;
+  for (size_t i = 0; i < l.size(); i++)
+    if (!(l[i] == r[i]))
+      return false;
+  return true;
+}
+template<typename L, typename R>
+typename std::enable_if<TIsMatExpr<L>::value && TIsMatExpr<R>::value &&
+  (TIsView<L>::value || TIsView<R>::value), bool>::type
+operator==(const L& l, const R& r)
+{
+  if (l.rows() != r.rows() || l.cols() != r.cols())
+    return false;
+  for (size_t i = 0; i < l.rows(); i++)
+    for (size_t j = 0; j < l.cols(); j++)
+      if (!(l(i, j) == r(i, j)))
+        return false;
+  return true;
+}
+template<typename L, typename R>
+typename std::enable_if<((TIsVecExpr<L>::value && TIsVecExpr<R>::value) ||
+  (TIsMatExpr<L>::value && TIsMatExpr<R>::value)) && (TIsView<L>::value || TIsView<R>::value), bool>::type
+operator!=(const L& l, const R& r)
+{
+  return !(l == r);
+}
+
+// матрицы, хранимые по столбцам и блоками
+#include "tlayout.h"
+
+#endif
@@ -0,0 +1,78 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Поэлементные операции и умножение матрицы на вектор: строки,
+// выровненные на строку кэша, против строк со сдвигом 16 байт
+
+#include <iostream>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+// Распределитель, сдвигающий блок на 16 байт от границы строки кэша:
+// так выглядела память new T[n] без выравнивания в худшем случае
+template<typename T>
+struct TShiftedAllocator
+{
+  typedef T value_type;
+
+  TShiftedAllocator() noexcept {}
+  template<typename U>
+  TShiftedAllocator(const TShiftedAllocator<U>&) noexcept {}
+
+  T* allocate(size_t n)
+  {
+    return reinterpret_cast<T*>(static_cast<char*>(aligned_allocate(n * sizeof(T) + 16, 64)) + 16);
+  }
+  void deallocate(T* p, size_t) noexcept
+  {
+    aligned_deallocate(reinterpret_cast<char*>(p) - 16);
+  }
+
+  friend bool operator==(const TShiftedAllocator&, const TShiftedAllocator&) noexcept { return true; }
+  friend bool operator!=(const TShiftedAllocator&, const TShiftedAllocator&) noexcept { return false; }
+};
+
+template<typename T, typename A>
+void bench(const char* name, size_t n, int reps)
+{
+  TDynamicMatrix<T, A> a(n), b(n), c(n);
+  TDynamicVector<T, A> x(n), y(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    x[i] = T(i % 3);
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = T((i + j) % 7);
+      b[i][j] = T((i * j) % 5);
+    }
+  }
+
+  double tadd = bench_seconds([&]() {
+    for (int r = 0; r < reps; r++)
+      c = a + b;
+  });
+  double tmv = bench_seconds([&]() {
+    for (int r = 0; r < reps; r++)
+      gemv(T(1), a, x, T(), y);
+  });
+  cout << name << " n = " << n << ", stride = " << a.stride() << ": c = a + b "
+    << 3.0 * n * n * sizeof(T) * reps / tadd * 1e-9 << " GB/s, gemv "
+    << 2.0 * n * n * reps / tmv * 1e-9 << " GFLOP/s" << endl;
+  if (c[0][0] + y[0] < T())
+    cout << c[0][0] << endl;
+}
+
+int main()
+{
+  const size_t sizes[] = { 64, 100, 256, 500 };
+  for (size_t n : sizes)
+  {
+    const int reps = int(20000000 / (n * n)) + 1;
+    bench<float, TAlignedAllocator<float>>("float  aligned", n, reps);
+    bench<float, TShiftedAllocator<float>>("float  shifted", n, reps);
+    bench<double, TAlignedAllocator<double>>("double aligned", n, reps);
+    bench<double, TShiftedAllocator<double>>("double shifted", n, reps);
+  }
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,44 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Замер числа выделений памяти при создании матриц
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const int iters = 100;
+
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicMatrix<double> m(n);
+      m[n - 1][n - 1] = 1.0;
+    }
+  }, 1);
+  TAllocStats d = TAllocStats::now() - s0;
+
+  cout << "TDynamicMatrix<double>(" << n << "): "
+    << double(d.count) / iters << " allocations, "
+    << double(d.bytes) / iters << " bytes, "
+    << t / iters * 1e3 << " ms per construction" << endl;
+
+  TDynamicMatrix<double> src(n);
+  s0 = TAllocStats::now();
+  for (int i = 0; i < iters; i++)
+  {
+    TDynamicMatrix<double> m(src);
+    m[0][0] = 1.0;
+  }
+  d = TAllocStats::now() - s0;
+  cout << "TDynamicMatrix<double> copy: "
+    << double(d.count) / iters << " allocations per copy" << endl;
+
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,66 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Итерационный процесс с временными матрицами: куча против арены
+
+#include <iostream>
+#include <cstdlib>
+#include "tarena.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+// Шаг итерации: несколько временных матриц и векторов типа M и V,
+// результат накапливается в x
+template<typename M, typename V>
+void step(const TDynamicMatrix<double>& a, TDynamicVector<double>& x)
+{
+  const size_t n = a.size();
+  M r(n), s(n);
+  for (size_t i = 0; i < n; i++)
+    r[i][i] = 1.0;
+  M t(r * 0.5 + s);
+  M u(t - r * 0.25);
+  V g(n), h(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    g[i] = u[i][i];
+    h[i] = x[i] * 0.5;
+  }
+  V w(g + h);
+  for (size_t i = 0; i < n; i++)
+    x[i] = w[i];
+}
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 64;
+  const int iters = 2000;
+
+  TDynamicMatrix<double> a(n);
+  TDynamicVector<double> x(n);
+
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+      step<TDynamicMatrix<double>, TDynamicVector<double>>(a, x);
+  });
+  TAllocStats d = TAllocStats::now() - s0;
+  cout << "n = " << n << ", heap:  " << double(d.count) / iters / 3 << " allocations, "
+    << t / iters * 1e6 << " us per iteration" << endl;
+
+  TMatrixArena arena;
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TArenaScope scope(arena);
+      step<TArenaMatrix<double>, TArenaVector<double>>(a, x);
+    }
+  });
+  d = TAllocStats::now() - s0;
+  cout << "n = " << n << ", arena: " << double(d.count) / iters / 3 << " allocations, "
+    << t / iters * 1e6 << " us per iteration (" << arena.block_count() << " blocks, "
+    << arena.capacity() << " bytes)" << endl;
+
+  return x[0] > 1.0 ? 1 : 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,58 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Сравнение скорости и точности режимов скалярного произведения
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+// последовательное суммирование одним аккумулятором
+template<typename T>
+T dot_serial(const TDynamicVector<T>& a, const TDynamicVector<T>& b)
+{
+  T res = T();
+  for (size_t i = 0; i < a.size(); i++)
+    res += a[i] * b[i];
+  return res;
+}
+
+template<typename T>
+void bench_dot(const char* type, size_t n)
+{
+  TDynamicVector<T> a(n), b(n);
+  unsigned seed = 12345;
+  long double exact = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    seed = seed * 1103515245u + 12345u;
+    a[i] = T(seed % 100000) / T(1000);
+    seed = seed * 1103515245u + 12345u;
+    b[i] = T(seed % 100000) / T(100000) - T(0.45);
+    exact += (long double)a[i] * (long double)b[i];
+  }
+
+  volatile T sink = T();
+  T r_serial = dot_serial(a, b), r_fast = dot(a, b), r_comp = dot(a, b, DOT_COMPENSATED);
+  double t_serial = bench_seconds([&]() { sink = dot_serial(a, b); }, 5);
+  double t_fast = bench_seconds([&]() { sink = dot(a, b); }, 5);
+  double t_comp = bench_seconds([&]() { sink = dot(a, b, DOT_COMPENSATED); }, 5);
+
+  auto rel = [&](T r) { return double(fabsl((long double)r - exact) / fabsl(exact)); };
+  cout << type << " n = " << n << endl
+    << "  serial:      " << n / t_serial * 1e-9 << " Gelem/s, rel. error " << rel(r_serial) << endl
+    << "  fast:        " << n / t_fast * 1e-9 << " Gelem/s, rel. error " << rel(r_fast) << endl
+    << "  compensated: " << n / t_comp * 1e-9 << " Gelem/s, rel. error " << rel(r_comp) << endl;
+}
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+
+  bench_dot<float>("float", n);
+  bench_dot<double>("double", n);
+  return 0;
+}
+//---------------------------------------------------------------------------
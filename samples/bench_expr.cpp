@@ -0,0 +1,77 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Выделения памяти и время вычисления поэлементных выражений
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const int iters = 20;
+
+  TDynamicVector<double> a(n * n), b(n * n), c(n * n), r(n * n);
+  TDynamicMatrix<double> ma(n), mb(n), mc(n), mr(n);
+
+  // каждая операция вычисляется в свой временный вектор
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicVector<double> t1(b * 2.0);
+      TDynamicVector<double> t2(a + t1);
+      r = t2 - c;
+    }
+  }, 1);
+  TAllocStats d = TAllocStats::now() - s0;
+  cout << "vector r = a + b * 2 - c, eager:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+      r = a + b * 2.0 - c;
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "vector r = a + b * 2 - c, fused:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  // новый результат: обнулённый вектор и затем запись против записи
+  // в неинициализированную память
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicVector<double> v(n * n);
+      v = a + b * 2.0 - c;
+      r[i] = v[i];
+    }
+  }, 1);
+  cout << "vector v(n); v = a + b * 2 - c:   " << t / iters * 1e3 << " ms" << endl;
+
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicVector<double> v(a + b * 2.0 - c);
+      r[i] = v[i];
+    }
+  }, 1);
+  cout << "vector v(a + b * 2 - c):          " << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicMatrix<double> m(ma + mb * 2.0 - mc);
+      mr = m;
+    }
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "matrix m = a + b * 2 - c, fused:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,42 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Замер производительности умножения матриц (GFLOP/s)
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+template<typename T>
+void bench_gemm(const char* name, size_t n)
+{
+  TDynamicMatrix<T> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = T((i + j) % 7) / T(7);
+      b[i][j] = T((i * j) % 5) / T(5);
+    }
+  double t = bench_seconds([&]() { c = a * b; }, n <= 1024 ? 3 : 1);
+  cout << name << " n = " << n << ": " << t * 1e3 << " ms, "
+    << 2.0 * n * n * n / t * 1e-9 << " GFLOP/s" << endl;
+}
+
+int main(int argc, char** argv)
+{
+  vector<size_t> sizes;
+  for (int i = 1; i < argc; i++)
+    sizes.push_back(std::atoi(argv[i]));
+  if (sizes.empty())
+    sizes = { 256, 1024, 4096 };
+
+  for (size_t n : sizes)
+  {
+    bench_gemm<float>("float ", n);
+    bench_gemm<double>("double", n);
+  }
+  return 0;
+}
+//---------------------------------------------------------------------------
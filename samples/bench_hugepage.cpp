@@ -0,0 +1,48 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Обход больших матриц по столбцам и транспонирование:
+// обычные страницы против больших
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+void bench(const char* name, THugePageMode mode, size_t n)
+{
+  THugePages::set_mode(mode);
+  TDynamicMatrix<double> a(n, UNINITIALIZED), b(n, UNINITIALIZED);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double((i + j) % 7);
+
+  double sum = 0.0;
+  double tcol = bench_seconds([&]() {
+    for (size_t j = 0; j < n; j++)
+      for (size_t i = 0; i < n; i++)
+        sum += a[i][j];
+  });
+  double ttr = bench_seconds([&]() {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        b[j][i] = a[i][j];
+  });
+
+  const THugePageStats s = THugePages::stats();
+  cout << name << " n = " << n << ": column sweep " << tcol * 1e3 << " ms, transpose "
+    << ttr * 1e3 << " ms; mapped " << (s.bytes >> 20) << " MiB in " << s.blocks
+    << " blocks, kernel huge pages " << (THugePages::anon_huge_bytes() >> 20) << " MiB" << endl;
+  if (sum < 0.0 || b[1][0] < 0.0)
+    cout << sum << endl;
+  THugePages::set_mode(HUGE_PAGES_OFF);
+}
+
+int main(int argc, char** argv)
+{
+  const size_t n = argc > 1 ? std::atoi(argv[1]) : 4000;
+  bench("4 KiB pages ", HUGE_PAGES_OFF, n);
+  bench("huge pages  ", HUGE_PAGES_TRANSPARENT, n);
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,64 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Выделения памяти в циклах с операциями с присваиванием
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 500;
+  const int iters = 20;
+
+  TDynamicVector<double> x(n * n), y(n * n);
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  for (size_t i = 0; i < n * n; i++)
+  {
+    x[i] = 1.0;
+    y[i] = 1e-3;
+  }
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = 1e-3;
+      b[i][j] = 1e-3;
+    }
+  c += a * b; // первый вызов заводит буферы упаковки ядра умножения
+
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      x += y * 2.0;
+      x -= y;
+      x *= 0.5;
+    }
+  }, 1);
+  TAllocStats d = TAllocStats::now() - s0;
+  cout << "vector x += y * 2; x -= y; x *= 0.5: " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+      c += a * b;
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "matrix c += a * b:                   " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+      c = a * b;
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "matrix c = a * b:                    " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  return 0;
+}
+//---------------------------------------------------------------------------
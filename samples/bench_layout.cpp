@@ -0,0 +1,88 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Порядок хранения матриц: преобразование поэлементным обходом против
+// блочного, сумма матриц одного и разного порядка хранения, умножение
+// матриц, хранимых по столбцам
+
+#include <iostream>
+#include <cstdlib>
+#include "tlayout.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  const size_t n = argc > 1 ? std::atoi(argv[1]) : 4000;
+  TDynamicMatrix<double> a(n, UNINITIALIZED), r(n, UNINITIALIZED);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double((i * 7 + j) % 100);
+  TColMajorMatrix<double> c(n, UNINITIALIZED), d(n, UNINITIALIZED);
+  TTiledMatrix<double> t(n, UNINITIALIZED);
+  double sink = 0.0;
+
+  double tn = bench_seconds([&]() {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        c(i, j) = a[i][j];
+    sink += c(n - 1, 0);
+  });
+  double tb = bench_seconds([&]() {
+    c = a;
+    sink += c(n - 1, 0);
+  });
+  double tt = bench_seconds([&]() {
+    t = c;
+    sink += t(n - 1, 0);
+  });
+  double tr = bench_seconds([&]() {
+    r = t;
+    sink += r[n - 1][0];
+  });
+  cout << "layout conversion " << n << " x " << n << ": row -> col naive " << tn * 1e3 << " ms, blocked "
+    << tb * 1e3 << " ms; col -> tiled " << tt * 1e3 << " ms; tiled -> row " << tr * 1e3 << " ms" << endl;
+
+  d = a;
+  double ts = bench_seconds([&]() {
+    r = a + a;
+    sink += r[0][0];
+  });
+  double tc = bench_seconds([&]() {
+    d = c + c;
+    sink += d(0, 0);
+  });
+  double tm = bench_seconds([&]() {
+    r = a + c;
+    sink += r[0][0];
+  });
+  double tmn = bench_seconds([&]() {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        r[i][j] = a[i][j] + c(i, j);
+    sink += r[0][0];
+  });
+  cout << "sum " << n << " x " << n << ": row + row " << ts * 1e3 << " ms, col + col " << tc * 1e3
+    << " ms, row + col blocked " << tm * 1e3 << " ms, naive " << tmn * 1e3 << " ms" << endl;
+
+  const size_t m = n / 4;
+  TDynamicMatrix<double> pa(m, UNINITIALIZED), pr(m, UNINITIALIZED);
+  for (size_t i = 0; i < m; i++)
+    for (size_t j = 0; j < m; j++)
+      pa[i][j] = double((i + 3 * j) % 17);
+  TColMajorMatrix<double> pc = pa, pd(m, UNINITIALIZED);
+  double tpr = bench_seconds([&]() {
+    pr = pa * pa;
+    sink += pr[0][0];
+  });
+  double tpc = bench_seconds([&]() {
+    pd = pc * pc;
+    sink += pd(0, 0);
+  });
+  cout << "product " << m << " x " << m << ": row-major " << tpr * 1e3 << " ms, col-major "
+    << tpc * 1e3 << " ms" << endl;
+
+  if (sink < 0.0)
+    cout << sink << endl;
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Загрузка матрицы: разбор текста operator>> против отображения
+// двоичного файла
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include "tmapped.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  const size_t n = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const char* text = "bench_mapped.txt";
+  const char* bin = "bench_mapped.bin";
+
+  TDynamicMatrix<double> a(n, UNINITIALIZED);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double((i * 31 + j) % 1000) / 8.0;
+  {
+    ofstream f(text);
+    f << a;
+  }
+  TMappedMatrix<double>::save(bin, a);
+
+  double sum = 0.0;
+  double tt = bench_seconds([&]() {
+    ifstream f(text);
+    TDynamicMatrix<double> m(n, UNINITIALIZED);
+    f >> m;
+    sum += m[n - 1][n - 1];
+  }, 1);
+  double to = bench_seconds([&]() {
+    TMappedMatrix<const double> m(bin);
+    sum += m[n - 1][n - 1];
+  });
+  double tp = bench_seconds([&]() {
+    TMappedMatrix<const double> m(bin);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        sum += m[i][j];
+  });
+
+  cout << "n = " << n << ": operator>> " << tt * 1e3 << " ms, mapped open "
+    << to * 1e6 << " us, mapped open + full pass " << tp * 1e3 << " ms" << endl;
+  if (sum < 0.0)
+    cout << sum << endl;
+  std::remove(text);
+  std::remove(bin);
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,48 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Создание и удаление матриц одинаковых размеров: куча против пула буферов
+
+#include <iostream>
+#include <cstdlib>
+#include "tpool.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+template<typename M>
+double churn(size_t n, int iters)
+{
+  double sink = 0.0;
+  for (int i = 0; i < iters; i++)
+  {
+    M a(n + i % 4), b(n + i % 4);
+    a[0][0] = 1.0;
+    b[n - 1][n - 1] = a[0][0];
+    sink += b[n - 1][n - 1];
+  }
+  return sink;
+}
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 300;
+  const int iters = 2000;
+  double sink = 0.0;
+
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() { sink += churn<TDynamicMatrix<double>>(n, iters); });
+  TAllocStats d = TAllocStats::now() - s0;
+  cout << "n = " << n << ", heap: " << double(d.count) / iters / 3 << " allocations, "
+    << t / iters * 1e6 << " us per iteration" << endl;
+
+  TBufferPool& pool = TBufferPool::instance();
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() { sink += churn<TPoolMatrix<double>>(n, iters); });
+  d = TAllocStats::now() - s0;
+  TPoolStats ps = pool.stats();
+  cout << "n = " << n << ", pool: " << double(d.count) / iters / 3 << " allocations, "
+    << t / iters * 1e6 << " us per iteration, hit rate " << ps.hit_rate()
+    << ", " << ps.bytes_held << " bytes held" << endl;
+
+  return sink > 0.0 ? 0 : 1;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,41 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Замер умножения прямоугольных матриц (GFLOP/s): высокие узкие,
+// низкие широкие и произведения с малой внутренней размерностью
+
+#include <iostream>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+template<typename T>
+void fill(TDynamicMatrix<T>& a, size_t seed)
+{
+  for (size_t i = 0; i < a.rows(); i++)
+    for (size_t j = 0; j < a.cols(); j++)
+      a[i][j] = T((i * seed + j) % 13) / T(13);
+}
+
+template<typename T>
+void bench_shape(const char* name, size_t m, size_t k, size_t n)
+{
+  TDynamicMatrix<T> a(m, k), b(k, n), c(m, n);
+  fill(a, 3);
+  fill(b, 5);
+  double t = bench_seconds([&]() { c = a * b; });
+  cout << name << " (" << m << " x " << k << ") * (" << k << " x " << n << "): "
+    << t * 1e3 << " ms, " << 2.0 * m * n * k / t * 1e-9 << " GFLOP/s" << endl;
+}
+
+int main()
+{
+  bench_shape<double>("square      ", 1024, 1024, 1024);
+  bench_shape<double>("tall-skinny ", 1000000, 64, 64);
+  bench_shape<double>("tall, k = 4 ", 1000000, 4, 64);
+  bench_shape<double>("short-wide  ", 64, 64, 1000000);
+  bench_shape<double>("inner, 64   ", 64, 1000000, 64);
+  bench_shape<double>("few columns ", 4000, 4000, 3);
+  bench_shape<double>("few rows    ", 3, 4000, 4000);
+  return 0;
+}
+//---------------------------------------------------------------------------
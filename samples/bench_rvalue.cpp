@@ -0,0 +1,79 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Выделения памяти в выражениях с временными векторами и матрицами
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 1000;
+  const int iters = 20;
+
+  TDynamicMatrix<double> m(n), a(n);
+  TDynamicVector<double> x(n), y(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    x[i] = 1.0;
+    y[i] = 2.0;
+    m[i][i] = 1.0;
+  }
+  double sink = 0.0;
+
+  // временный результат сохранён в переменной: выражение пишет в новый вектор
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicVector<double> mx = m * x;
+      TDynamicVector<double> r = mx * 2.0 + y;
+      sink += r[0];
+    }
+  }, 1);
+  TAllocStats d = TAllocStats::now() - s0;
+  cout << "vector r = (m * x) * 2 + y, lvalue:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicVector<double> r = (m * x) * 2.0 + y;
+      sink += r[0];
+    }
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "vector r = (m * x) * 2 + y, rvalue:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicMatrix<double> c(m);
+      TDynamicMatrix<double> r = c * 2.0 - a;
+      sink += r[0][0];
+    }
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "matrix r = copy(m) * 2 - a, lvalue:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicMatrix<double> r = TDynamicMatrix<double>(m) * 2.0 - a;
+      sink += r[0][0];
+    }
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << "matrix r = copy(m) * 2 - a, rvalue:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e3 << " ms" << endl;
+
+  return sink > 0.0 ? 0 : 1;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,56 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Создание и удаление коротких векторов: встроенный буфер против кучи
+
+#include <iostream>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+template<typename T>
+void bench(const char* name, size_t n, int iters)
+{
+  T sink = T();
+
+  // прежняя схема: каждый вектор выделяет память в куче
+  TAllocStats s0 = TAllocStats::now();
+  double th = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      T* p = new T[n]();
+      p[n - 1] += T(1);
+      sink += p[0];
+      delete[] p;
+    }
+  });
+  TAllocStats dh = TAllocStats::now() - s0;
+
+  s0 = TAllocStats::now();
+  double tv = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicVector<T> v(n);
+      v[n - 1] += T(1);
+      sink += v[0];
+    }
+  });
+  TAllocStats dv = TAllocStats::now() - s0;
+
+  cout << name << " n = " << n << ": new[] " << th / iters * 1e9 << " ns, "
+    << double(dh.count) / iters / 3 << " allocations; TDynamicVector "
+    << tv / iters * 1e9 << " ns, " << double(dv.count) / iters / 3 << " allocations" << endl;
+  if (sink < T())
+    cout << sink << endl;
+}
+
+int main()
+{
+  const int iters = 1000000;
+  const size_t sizes[] = { 1, 2, 4, 8, 16, 32, 64 };
+  for (size_t n : sizes)
+    bench<int>("int   ", n, iters);
+  for (size_t n : sizes)
+    bench<double>("double", n, iters);
+  return 0;
+}
+//---------------------------------------------------------------------------
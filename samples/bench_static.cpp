@@ -0,0 +1,67 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матрицы 3x3 и 4x4: динамические и фиксированного размера
+
+#include <iostream>
+#include "tmatrix.h"
+#include "tstaticmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+template<size_t N>
+void bench(int iters)
+{
+  TDynamicMatrix<double> da(N), db(N);
+  TDynamicVector<double> dv(N);
+  TStaticMatrix<double, N> sa, sb;
+  TStaticVector<double, N> sv;
+  for (size_t i = 0; i < N; i++)
+  {
+    dv[i] = sv[i] = 1.0;
+    for (size_t j = 0; j < N; j++)
+    {
+      da[i][j] = sa[i][j] = 1.0 / double(i + j + 1);
+      db[i][j] = sb[i][j] = i == j ? 1.0 : 0.0;
+    }
+  }
+  double sink = 0.0;
+
+  TAllocStats s0 = TAllocStats::now();
+  double t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TDynamicMatrix<double> c = da * db + da;
+      TDynamicVector<double> r = c * dv;
+      sink += r[0];
+    }
+  }, 1);
+  TAllocStats d = TAllocStats::now() - s0;
+  cout << N << "x" << N << " TDynamicMatrix: " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e9 << " ns" << endl;
+
+  s0 = TAllocStats::now();
+  t = bench_seconds([&]() {
+    for (int i = 0; i < iters; i++)
+    {
+      TStaticMatrix<double, N> c = sa * sb + sa;
+      TStaticVector<double, N> r = c * sv;
+      sink += r[0];
+      sa[0][0] += 1e-12;
+    }
+  }, 1);
+  d = TAllocStats::now() - s0;
+  cout << N << "x" << N << " TStaticMatrix:  " << double(d.count) / iters << " allocations, "
+    << t / iters * 1e9 << " ns" << endl;
+
+  if (sink == 0.0)
+    cout << sink << endl;
+}
+
+int main()
+{
+  const int iters = 1000000;
+  bench<3>(iters);
+  bench<4>(iters);
+  return 0;
+}
+//---------------------------------------------------------------------------
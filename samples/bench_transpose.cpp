@@ -0,0 +1,65 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Транспонирование: поэлементный обход против блочного, работа с блоком
+// матрицы: копия против представления
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+  const size_t n = argc > 1 ? std::atoi(argv[1]) : 4000;
+  TDynamicMatrix<double> a(n, UNINITIALIZED), b(n, UNINITIALIZED);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double((i * 7 + j) % 100);
+  double sink = 0.0;
+
+  double tn = bench_seconds([&]() {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        b[j][i] = a[i][j];
+    sink += b[n - 1][0];
+  });
+  double tb = bench_seconds([&]() {
+    transpose(a, b);
+    sink += b[n - 1][0];
+  });
+  double ti = bench_seconds([&]() {
+    transpose(b);
+    sink += b[n - 1][0];
+  });
+  cout << "transpose " << n << " x " << n << ": naive " << tn * 1e3 << " ms, blocked "
+    << tb * 1e3 << " ms, blocked in place " << ti * 1e3 << " ms" << endl;
+
+  // правый нижний квадрант умножается на число и прибавляется к левому верхнему
+  const size_t h = n / 2;
+  TAllocStats s0 = TAllocStats::now();
+  double tc = bench_seconds([&]() {
+    TDynamicMatrix<double> q(h, UNINITIALIZED);
+    for (size_t i = 0; i < h; i++)
+      std::copy(a[h + i].data() + h, a[h + i].data() + n, q[i].data());
+    q *= 0.5;
+    for (size_t i = 0; i < h; i++)
+      for (size_t j = 0; j < h; j++)
+        b[i][j] += q[i][j];
+    sink += b[0][0];
+  });
+  TAllocStats dc = TAllocStats::now() - s0;
+  s0 = TAllocStats::now();
+  double tv = bench_seconds([&]() {
+    b.block(0, 0, h, h) += a.block(h, h, h, h) * 0.5;
+    sink += b[0][0];
+  });
+  TAllocStats dv = TAllocStats::now() - s0;
+  cout << "block update " << h << " x " << h << ": copy " << tc * 1e3 << " ms, " << (dc.bytes / 3 >> 20)
+    << " MiB allocated; view " << tv * 1e3 << " ms, " << (dv.bytes / 3 >> 20) << " MiB allocated" << endl;
+
+  if (sink < 0.0)
+    cout << sink << endl;
+  return 0;
+}
+//---------------------------------------------------------------------------
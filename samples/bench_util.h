@@ -0,0 +1,74 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Вспомогательные средства для замеров производительности:
+// таймер и счётчик выделений динамической памяти.
+// Заголовок подменяет глобальные operator new/delete, поэтому
+// подключается ровно в один cpp-файл каждой программы замеров.
+
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+static size_t g_alloc_count = 0;
+static size_t g_alloc_bytes = 0;
+
+void* operator new(size_t n)
+{
+  g_alloc_count++;
+  g_alloc_bytes += n;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n)
+{
+  return operator new(n);
+}
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+  std::free(p);
+}
+void operator delete[](void* p, size_t) noexcept
+{
+  std::free(p);
+}
+
+// Снимок счётчиков выделений
+struct TAllocStats
+{
+  size_t count;
+  size_t bytes;
+
+  static TAllocStats now() { return TAllocStats{ g_alloc_count, g_alloc_bytes }; }
+  TAllocStats operator-(const TAllocStats& s) const { return TAllocStats{ count - s.count, bytes - s.bytes }; }
+};
+
+// Время выполнения f в секундах (минимум из reps повторов)
+template<typename F>
+double bench_seconds(F f, int reps = 3)
+{
+  double best = 1e300;
+  for (int r = 0; r < reps; r++)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    double s = std::chrono::duration<double>(t1 - t0).count();
+    if (s < best)
+      best = s;
+  }
+  return best;
+}
+
+#endif
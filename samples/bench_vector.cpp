@@ -0,0 +1,55 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Замер поэлементных векторных ядер на каждом доступном уровне SIMD
+
+#include <iostream>
+#include <cstdlib>
+#include "tmatrix.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+static const char* level_name(int level)
+{
+  static const char* names[] = { "portable", "sse2", "avx2", "avx512" };
+  return names[level];
+}
+
+template<typename T>
+void bench_kernels(const char* type, size_t n)
+{
+  TDynamicVector<T> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    a[i] = T(i % 13);
+    b[i] = T(i % 7);
+  }
+  T* pa = &a[0];
+  T* pb = &b[0];
+  T* pc = &c[0];
+  volatile T sink = T();
+  for (int level = SIMD_PORTABLE; level <= SIMD_AVX512; level++)
+  {
+    const TVecKernels<T>* k = vec_kernels_for<T>(TSimdLevel(level));
+    if (k == nullptr)
+      continue;
+    double add = bench_seconds([&]() { k->add(pa, pb, pc, n); }, 10);
+    double mul = bench_seconds([&]() { k->mul_scalar(pa, T(3), pc, n); }, 10);
+    double dot = bench_seconds([&]() { sink = k->dot(pa, pb, n); }, 10);
+    cout << type << " " << level_name(level) << ": add " << n / add * 1e-9
+      << " Gelem/s, mul_scalar " << n / mul * 1e-9
+      << " Gelem/s, dot " << n / dot * 1e-9 << " Gelem/s" << endl;
+  }
+  cout << type << " selected: " << level_name(cpu_features().level()) << endl;
+}
+
+int main(int argc, char** argv)
+{
+  size_t n = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+  bench_kernels<float>("float ", n);
+  bench_kernels<double>("double", n);
+  bench_kernels<int32_t>("int32 ", n);
+  bench_kernels<int64_t>("int64 ", n);
+  return 0;
+}
+//---------------------------------------------------------------------------
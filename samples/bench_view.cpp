@@ -0,0 +1,60 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Работа с внешним буфером: копия в TDynamicVector/TDynamicMatrix
+// против представления без копирования
+
+#include <iostream>
+#include <vector>
+#include "tview.h"
+#include "bench_util.h"
+//---------------------------------------------------------------------------
+
+int main()
+{
+  const size_t n = 1000000, m = 1000;
+  std::vector<double> a(n, 1.5), b(n, 0.5);
+  std::vector<double> mbuf(m * m, 0.25);
+  TDynamicVector<double> x(m);
+  for (size_t i = 0; i < m; i++)
+    x[i] = double(i % 3);
+  double sink = 0.0;
+
+  TAllocStats s0 = TAllocStats::now();
+  double tc = bench_seconds([&]() {
+    TDynamicVector<double> va(a.data(), n), vb(b.data(), n);
+    sink += va * vb;
+  });
+  TAllocStats dc = TAllocStats::now() - s0;
+  s0 = TAllocStats::now();
+  double tv = bench_seconds([&]() {
+    TVectorView<double> va(a.data(), n), vb(b.data(), n);
+    sink += va * vb;
+  });
+  TAllocStats dv = TAllocStats::now() - s0;
+  cout << "dot, n = " << n << ": copies " << tc * 1e3 << " ms, " << (dc.bytes / 3 >> 20)
+    << " MiB allocated; views " << tv * 1e3 << " ms, " << (dv.bytes / 3 >> 20) << " MiB allocated" << endl;
+
+  s0 = TAllocStats::now();
+  tc = bench_seconds([&]() {
+    TDynamicMatrix<double> ma(m);
+    for (size_t i = 0; i < m; i++)
+      std::copy(mbuf.data() + i * m, mbuf.data() + (i + 1) * m, ma[i].data());
+    TDynamicVector<double> y = ma * x;
+    sink += y[0];
+  });
+  dc = TAllocStats::now() - s0;
+  s0 = TAllocStats::now();
+  tv = bench_seconds([&]() {
+    TMatrixView<double> ma(mbuf.data(), m);
+    TDynamicVector<double> y = ma * x;
+    sink += y[0];
+  });
+  dv = TAllocStats::now() - s0;
+  cout << "gemv, n = " << m << ": copy " << tc * 1e3 << " ms, " << (dc.bytes / 3 >> 20)
+    << " MiB allocated; view " << tv * 1e3 << " ms, " << (dv.bytes / 3 >> 20) << " MiB allocated" << endl;
+
+  if (sink < 0.0)
+    cout << sink << endl;
+  return 0;
+}
+//---------------------------------------------------------------------------
@@ -0,0 +1,35 @@
+// Распределитель для тестов: считает живые блоки в общем счётчике
+
+#ifndef __TEST_ALLOCATOR_H__
+#define __TEST_ALLOCATOR_H__
+
+#include <memory>
+#include <cstddef>
+
+template<typename T>
+struct TCountingAllocator
+{
+  typedef T value_type;
+
+  size_t* blocks;
+
+  explicit TCountingAllocator(size_t* counter) : blocks(counter) {}
+  template<typename U>
+  TCountingAllocator(const TCountingAllocator<U>& a) : blocks(a.blocks) {}
+
+  T* allocate(size_t n)
+  {
+    ++*blocks;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n)
+  {
+    --*blocks;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  friend bool operator==(const TCountingAllocator& a, const TCountingAllocator& b) { return a.blocks == b.blocks; }
+  friend bool operator!=(const TCountingAllocator& a, const TCountingAllocator& b) { return a.blocks != b.blocks; }
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+// включает режим больших страниц на время теста
+struct THugePageGuard
+{
+  THugePageGuard(THugePageMode m, size_t threshold) { THugePages::set_mode(m, threshold); }
+  ~THugePageGuard() { THugePages::set_mode(HUGE_PAGES_OFF); }
+};
+
+TEST(TAlignedAllocator, returns_aligned_blocks)
+{
+  TAlignedAllocator<char> a;
+  for (size_t n = 1; n < 200; n += 7)
+  {
+    char* p = a.allocate(n);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(p) % TMATRIX_ALIGNMENT);
+    a.deallocate(p, n);
+  }
+}
+
+TEST(TAlignedAllocator, vectors_and_matrices_move_without_exceptions)
+{
+  EXPECT_TRUE(std::is_nothrow_move_constructible<TDynamicVector<double>>::value);
+  EXPECT_TRUE(std::is_nothrow_move_assignable<TDynamicVector<double>>::value);
+  EXPECT_TRUE(std::is_nothrow_move_constructible<TDynamicMatrix<double>>::value);
+  EXPECT_TRUE(std::is_nothrow_move_assignable<TDynamicMatrix<double>>::value);
+}
+
+TEST(THugePages, small_blocks_stay_on_heap)
+{
+  THugePageGuard g(HUGE_PAGES_TRANSPARENT, 1 << 20);
+  TDynamicVector<double> v(1000);
+
+  EXPECT_EQ(0u, THugePages::stats().blocks);
+}
+
+TEST(THugePages, large_matrix_is_mapped_or_falls_back_to_heap)
+{
+  THugePageGuard g(HUGE_PAGES_TRANSPARENT, 1 << 20);
+  {
+    TDynamicMatrix<double> m(600);
+    m[599][599] = 2.0;
+    const THugePageStats s = THugePages::stats();
+
+    // без поддержки больших страниц блок берётся из кучи
+    EXPECT_LE(s.blocks, 1u);
+    if (s.blocks == 1)
+    {
+      EXPECT_LE(600 * m.stride() * sizeof(double), s.bytes);
+    }
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(m.data()) % TMATRIX_ALIGNMENT);
+    EXPECT_EQ(0.0, m[0][0]);
+    EXPECT_EQ(4.0, (m * 2.0)(599, 599));
+  }
+  EXPECT_EQ(0u, THugePages::stats().blocks);
+  EXPECT_EQ(0u, THugePages::stats().bytes);
+}
+
+TEST(THugePages, explicit_mode_falls_back_to_transparent_pages)
+{
+  THugePageGuard g(HUGE_PAGES_EXPLICIT, 1 << 20);
+  {
+    TDynamicVector<float> v(1 << 20);
+    v[(1 << 20) - 1] = 1.0f;
+
+    EXPECT_LE(THugePages::stats().hugetlb_bytes, THugePages::stats().bytes);
+  }
+  EXPECT_EQ(0u, THugePages::stats().bytes);
+  EXPECT_EQ(0u, THugePages::stats().hugetlb_bytes);
+}
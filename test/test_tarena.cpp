@@ -0,0 +1,54 @@
+#include "tarena.h"
+
+#include <gtest.h>
+
+TEST(TMatrixArena, allocates_aligned_memory_by_bump_pointer)
+{
+  TMatrixArena arena(1024);
+
+  char* p = static_cast<char*>(arena.allocate(10, 1));
+  char* q = static_cast<char*>(arena.allocate(16, 16));
+
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(q) % 16);
+  EXPECT_TRUE(q >= p + 10 && q < p + 10 + 16);
+  EXPECT_EQ(1u, arena.block_count());
+}
+
+TEST(TMatrixArena, scope_releases_memory_for_reuse)
+{
+  TMatrixArena arena(4096);
+  void* first = nullptr;
+  for (int i = 0; i < 3; i++)
+  {
+    TArenaScope scope(arena);
+    TArenaMatrix<double> m(10), t(m * 2.0 + m);
+    TArenaVector<double> v(100);
+    if (i == 0)
+      first = m.data();
+    EXPECT_EQ(first, m.data());
+    EXPECT_EQ(&arena, m.get_allocator().arena());
+  }
+  EXPECT_EQ(1u, arena.block_count());
+  EXPECT_EQ(nullptr, TMatrixArena::current());
+}
+
+TEST(TMatrixArena, grows_when_block_is_exhausted)
+{
+  TMatrixArena arena(1024);
+  TArenaScope scope(arena);
+
+  TArenaMatrix<double> a(8), b(20);
+  b[19][19] = 1.0;
+
+  EXPECT_EQ(2u, arena.block_count());
+  EXPECT_EQ(1.0, b[19][19]);
+}
+
+TEST(TMatrixArena, allocator_without_arena_uses_heap)
+{
+  TArenaVector<int> v(1000);
+  v[999] = 5;
+
+  EXPECT_EQ(nullptr, v.get_allocator().arena());
+  EXPECT_EQ(5, v[999]);
+}
@@ -0,0 +1,198 @@
+#include "tlayout.h"
+
+#include <gtest.h>
+
+template<typename M>
+void fill(M& a, size_t seed)
+{
+  for (size_t i = 0; i < a.rows(); i++)
+    for (size_t j = 0; j < a.cols(); j++)
+      a[i][j] = double((i * seed + j * 7) % 11) - 5.0;
+}
+
+TEST(TColMajorMatrix, stores_columns_contiguously)
+{
+  TColMajorMatrix<double> a(5, 3);
+  for (size_t i = 0; i < 5; i++)
+    for (size_t j = 0; j < 3; j++)
+      a[i][j] = double(10 * i + j);
+
+  EXPECT_EQ(5u, a.rows());
+  EXPECT_EQ(3u, a.cols());
+  EXPECT_EQ(8u, a.stride());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a.data()) % TMATRIX_ALIGNMENT);
+  EXPECT_EQ(41.0, a.data()[1 * a.stride() + 4]);
+  EXPECT_EQ(0.0, a.data()[5]);
+  EXPECT_EQ(32.0, a(3, 2));
+  ASSERT_ANY_THROW(a.at(5));
+  ASSERT_ANY_THROW(a[0].at(3));
+  ASSERT_ANY_THROW(TColMajorMatrix<double>(0, 3));
+}
+
+TEST(TTiledMatrix, stores_tiles_contiguously)
+{
+  TTiledMatrix<int, 4> a(6, 9);
+  for (size_t i = 0; i < 6; i++)
+    for (size_t j = 0; j < 9; j++)
+      a[i][j] = int(10 * i + j);
+
+  EXPECT_EQ(size_t(3 * 16), a.stride());
+  EXPECT_EQ(0, a.data()[0]);
+  EXPECT_EQ(13, a.data()[1 * 4 + 3]);
+  EXPECT_EQ(4, a.data()[16]);
+  EXPECT_EQ(40, a.data()[a.stride()]);
+  EXPECT_EQ(58, a(5, 8));
+}
+
+TEST(TTiledMatrix, can_create_max_size_matrix)
+{
+  TTiledMatrix<double> t(MAX_MATRIX_SIZE);
+  TColMajorMatrix<char> c(MAX_MATRIX_SIZE);
+
+  t(MAX_MATRIX_SIZE - 1, MAX_MATRIX_SIZE - 1) = 1.0;
+  EXPECT_EQ(1.0, t[MAX_MATRIX_SIZE - 1][MAX_MATRIX_SIZE - 1]);
+  EXPECT_EQ(0.0, t(0, 0));
+  EXPECT_EQ(size_t(MAX_MATRIX_SIZE), c.stride());
+  ASSERT_ANY_THROW(TTiledMatrix<double>(MAX_MATRIX_SIZE + 1));
+}
+
+TEST(TColMajorMatrix, converts_to_and_from_other_layouts)
+{
+  const size_t m = 70, n = 45;
+  TDynamicMatrix<double> a(m, n);
+  fill(a, 3);
+
+  TColMajorMatrix<double> c = a;
+  TTiledMatrix<double> t = c;
+  TDynamicMatrix<double> r = t, rc = c;
+
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(c, t);
+  EXPECT_EQ(a, r);
+  EXPECT_EQ(a, rc);
+  for (size_t i = 0; i < m; i++)
+    for (size_t j = 0; j < n; j++)
+      ASSERT_EQ(a[i][j], c.data()[j * c.stride() + i]);
+  c(3, 4) = 100.0;
+  EXPECT_NE(a, c);
+  EXPECT_NE(c, TColMajorMatrix<double>(a));
+}
+
+TEST(TColMajorMatrix, expressions_mix_layouts)
+{
+  const size_t m = 37, n = 50;
+  TDynamicMatrix<double> a(m, n);
+  TColMajorMatrix<double> b(m, n);
+  TTiledMatrix<double, 8> t(m, n);
+  fill(a, 3);
+  fill(b, 5);
+  fill(t, 2);
+
+  TColMajorMatrix<double> c = a + b * 2.0 - t;
+  TDynamicMatrix<double> r = b - a;
+  TTiledMatrix<double, 8> s = t + b;
+
+  for (size_t i = 0; i < m; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      ASSERT_EQ(a[i][j] + b[i][j] * 2.0 - t[i][j], c[i][j]);
+      ASSERT_EQ(b[i][j] - a[i][j], r[i][j]);
+      ASSERT_EQ(t[i][j] + b[i][j], s[i][j]);
+    }
+
+  c += b;
+  c -= a;
+  c *= 0.5;
+  EXPECT_EQ(0.5 * (2.0 * b(1, 2) + b(1, 2) - t(1, 2)), c(1, 2));
+  s *= 2.0;
+  s -= t;
+  EXPECT_EQ(t + b * 2.0, s);
+  ASSERT_ANY_THROW(c += TColMajorMatrix<double>(m, n + 1));
+}
+
+TEST(TColMajorMatrix, products_of_mixed_layouts)
+{
+  const size_t m = 23, k = 41, n = 19;
+  TDynamicMatrix<double> a(m, k), b(k, n);
+  fill(a, 3);
+  fill(b, 5);
+  TColMajorMatrix<double> ca = a, cb = b;
+  TTiledMatrix<double> tb = b;
+  TDynamicMatrix<double> p = a * b;
+
+  TColMajorMatrix<double> c1 = ca * cb, c2 = a * cb;
+  TDynamicMatrix<double> r1 = ca * b, r2 = a * tb;
+  TTiledMatrix<double> t1 = ca * tb;
+
+  EXPECT_EQ(p, c1);
+  EXPECT_EQ(p, c2);
+  EXPECT_EQ(p, r1);
+  EXPECT_EQ(p, r2);
+  EXPECT_EQ(p, t1);
+
+  c1 += ca * cb;
+  EXPECT_EQ(p * 2.0, c1);
+}
+
+TEST(TColMajorMatrix, matrix_vector_product_goes_by_columns)
+{
+  const size_t m = 13, n = 29;
+  TDynamicMatrix<double> a(m, n);
+  fill(a, 3);
+  TColMajorMatrix<double> c = a;
+  TTiledMatrix<double> t = a;
+  TDynamicVector<double> x(n);
+  for (size_t j = 0; j < n; j++)
+    x[j] = double(j % 4);
+
+  EXPECT_EQ(a * x, c * x);
+  EXPECT_EQ(a * x, t * x);
+  ASSERT_ANY_THROW(c * TDynamicVector<double>(m));
+}
+
+TEST(TTiledMatrix, matrix_vector_product_goes_by_tiles)
+{
+  const size_t m = 13, n = 29;
+  TDynamicMatrix<double> a(m, n), xs(n, 2);
+  fill(a, 3);
+  fill(xs, 5);
+  TTiledMatrix<double, 4> t = a;
+  TDynamicVector<double> x = xs.col(1);
+
+  EXPECT_EQ(a * x, t * x);
+  EXPECT_EQ(a * x, t * xs.col(1));
+  EXPECT_EQ(a * (x + x), t * (x + x));
+  ASSERT_ANY_THROW(t * TDynamicVector<double>(m));
+}
+
+TEST(TColMajorMatrix, rows_are_vector_expressions)
+{
+  const size_t m = 7, n = 9;
+  TDynamicMatrix<double> a(m, n);
+  fill(a, 3);
+  const TColMajorMatrix<double> c = a;
+  const TTiledMatrix<double, 4> t = a;
+  TDynamicVector<double> r = a[2];
+
+  EXPECT_EQ(c.stride(), c[2].inc());
+  EXPECT_EQ(c.data() + 2, c[2].data());
+  EXPECT_EQ(r, TDynamicVector<double>(c[2]));
+  EXPECT_EQ(r, TDynamicVector<double>(t[2]));
+  EXPECT_EQ(r * r, c[2] * r);
+  EXPECT_EQ(r * r, dot(c[2], r));
+  EXPECT_EQ(r * 2.0, TDynamicVector<double>(c[2] + t[2]));
+}
+
+TEST(TColMajorMatrix, can_assign_matrix_of_other_size)
+{
+  TColMajorMatrix<int> a(2, 3), b(4, 5);
+  b(3, 4) = 7;
+
+  a = b;
+  TColMajorMatrix<int> c = std::move(b);
+
+  EXPECT_EQ(4u, a.rows());
+  EXPECT_EQ(5u, a.cols());
+  EXPECT_EQ(7, a(3, 4));
+  EXPECT_EQ(a, c);
+}
@@ -0,0 +1,150 @@
+#include "tmapped.h"
+
+#include <gtest.h>
+#include <cstdio>
+
+#ifdef TMATRIX_HAS_MMAP
+
+// имя временного файла, удаляемого в конце теста
+struct TTempFile
+{
+  std::string path;
+  explicit TTempFile(const char* name) : path(std::string("test_tmapped_") + name + ".bin") {}
+  ~TTempFile() { std::remove(path.c_str()); }
+};
+
+TEST(TMappedMatrix, created_matrix_is_zero_and_aligned)
+{
+  TTempFile f("zero");
+  TMappedMatrix<double> m = TMappedMatrix<double>::create(f.path, 13);
+
+  EXPECT_EQ(13u, m.size());
+  EXPECT_EQ(16u, m.stride());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(m.data()) % TMATRIX_ALIGNMENT);
+  EXPECT_EQ(TDynamicMatrix<double>(13), m);
+}
+
+TEST(TMappedMatrix, rectangular_matrix_keeps_shape)
+{
+  TTempFile f("rect");
+  TDynamicMatrix<float> a(3, 21);
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 21; j++)
+      a[i][j] = float(i * 21 + j);
+
+  TMappedMatrix<float>::save(f.path, a);
+  TMappedMatrix<const float> m(f.path);
+
+  EXPECT_EQ(3u, m.rows());
+  EXPECT_EQ(21u, m.cols());
+  EXPECT_EQ(a, m);
+  EXPECT_EQ(a * TDynamicVector<float>(21), m * TDynamicVector<float>(21));
+}
+
+TEST(TMappedMatrix, saved_matrix_reopens_with_same_elements)
+{
+  TTempFile f("save");
+  TDynamicMatrix<int> a(20);
+  for (size_t i = 0; i < 20; i++)
+    for (size_t j = 0; j < 20; j++)
+      a[i][j] = int(i * 20 + j);
+
+  TMappedMatrix<int>::save(f.path, a);
+  TMappedMatrix<const int> m(f.path);
+
+  EXPECT_EQ(MAPPED_READ, m.access());
+  EXPECT_EQ(MAPPED_READ_WRITE, TMappedMatrix<int>::access());
+  EXPECT_EQ(a, m);
+  EXPECT_EQ(399, m.at(19)[19]);
+}
+
+TEST(TMappedMatrix, can_be_operand_of_expressions_and_products)
+{
+  TTempFile f("expr");
+  TDynamicMatrix<double> a(30);
+  TDynamicVector<double> x(30);
+  for (size_t i = 0; i < 30; i++)
+  {
+    x[i] = 1.0;
+    for (size_t j = 0; j < 30; j++)
+      a[i][j] = double(i + j % 3);
+  }
+  TMappedMatrix<double>::save(f.path, a);
+  TMappedMatrix<const double> m(f.path);
+
+  EXPECT_EQ(a * 2.0, m + a);
+  EXPECT_EQ(a * a, m * m);
+  EXPECT_EQ(a * x, m * x);
+}
+
+TEST(TMappedMatrix, writes_are_visible_to_other_mappings_of_file)
+{
+  TTempFile f("share");
+  TMappedMatrix<float> w = TMappedMatrix<float>::create(f.path, 8);
+  TMappedMatrix<const float> r(f.path);
+
+  w[3][5] = 2.5f;
+
+  EXPECT_NE(w.data(), r.data());
+  EXPECT_EQ(2.5f, r[3][5]);
+}
+
+TEST(TMappedMatrix, read_only_matrix_has_const_elements)
+{
+  typedef TMappedMatrix<const int> TReadOnly;
+  EXPECT_FALSE((std::is_assignable<TReadOnly&, TDynamicMatrix<int>>::value));
+  EXPECT_FALSE((std::is_assignable<decltype(std::declval<TReadOnly&>()[0][0]), int>::value));
+  EXPECT_TRUE((std::is_same<const int*, decltype(std::declval<TReadOnly&>().data())>::value));
+  EXPECT_FALSE((std::is_constructible<TMatrixView<int>, TReadOnly&>::value));
+
+  TTempFile f("ro");
+  TMappedMatrix<int>::save(f.path, TDynamicMatrix<int>(4));
+  TReadOnly m(f.path);
+
+  EXPECT_EQ(0, m[0][0]);
+  EXPECT_EQ(m.data(), TMatrixView<const int>(m).data());
+}
+
+TEST(TMappedMatrix, can_reopen_file_for_writing)
+{
+  TTempFile f("rw");
+  TMappedMatrix<int>::save(f.path, TDynamicMatrix<int>(4));
+  {
+    TMappedMatrix<int> m(f.path);
+    m[1][2] = 5;
+    m = m * 2;
+    m.flush();
+  }
+  TMappedMatrix<const int> r(f.path);
+
+  EXPECT_EQ(10, r[1][2]);
+  EXPECT_EQ(0, r[0][0]);
+}
+
+TEST(TMappedMatrix, size_is_not_limited_by_heap_matrix_limits)
+{
+  TTempFile f("large");
+  const size_t m = MAX_MATRIX_ELEMENTS / 1000 + 1;
+  {
+    TMappedMatrix<char> w = TMappedMatrix<char>::create(f.path, m, 1000);
+    w[m - 1][999] = 'x';
+    w.flush();
+  }
+  TMappedMatrix<const char> r(f.path);
+
+  EXPECT_EQ(m, r.rows());
+  EXPECT_EQ('x', r[m - 1][999]);
+  EXPECT_EQ(0, r[0][0]);
+}
+
+TEST(TMappedMatrix, cant_open_file_of_other_element_type)
+{
+  TTempFile f("type");
+  TMappedMatrix<int>::save(f.path, TDynamicMatrix<int>(4));
+
+  ASSERT_ANY_THROW(TMappedMatrix<const double> m(f.path));
+  ASSERT_ANY_THROW(TMappedMatrix<const int> m("test_tmapped_missing.bin"));
+  ASSERT_ANY_THROW(TMappedMatrix<int> m("test_tmapped_missing.bin"));
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include "tmatrix.h"
 
 #include <gtest.h>
+#include <sstream>
+#include "test_allocator.h"
 
 TEST(TDynamicMatrix, can_create_matrix_with_positive_length)
 {
@@ -109,3 +111,455 @@ TEST(TDynamicMatrix, cant_subtract_matrixes_with_not_equal_size)
   ADD_FAILURE();
 }
 
+
+TEST(TDynamicMatrix, rows_are_stored_with_fixed_stride)
+{
+  TDynamicMatrix<int> m(4);
+
+  for (size_t i = 1; i < m.size(); i++)
+    EXPECT_EQ(&m[i - 1][0] + m.stride(), &m[i][0]);
+}
+
+TEST(TDynamicMatrix, rows_are_padded_and_aligned)
+{
+  TDynamicMatrix<double> m(13);
+
+  EXPECT_EQ(16u, m.stride());
+  for (size_t i = 0; i < m.size(); i++)
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(m[i].data()) % TMATRIX_ALIGNMENT);
+}
+
+TEST(TDynamicMatrix, can_create_max_size_matrix_of_small_type)
+{
+  TDynamicMatrix<char> m(MAX_MATRIX_SIZE);
+
+  EXPECT_EQ(size_t(MAX_MATRIX_SIZE), m.stride());
+  m[MAX_MATRIX_SIZE - 1][MAX_MATRIX_SIZE - 1] = 'x';
+  EXPECT_EQ('x', m.data()[size_t(MAX_MATRIX_SIZE) * MAX_MATRIX_SIZE - 1]);
+}
+
+TEST(TDynamicMatrix, padding_does_not_affect_operations)
+{
+  const size_t n = 13;
+  TDynamicMatrix<double> a(n, UNINITIALIZED), e(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    e[i][i] = 1.0;
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double(i + 2 * j);
+  }
+
+  TDynamicMatrix<double> b = a * e + a * 2.0;
+  b -= a;
+  b *= 0.5;
+
+  EXPECT_EQ(a, b);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = n; j < a.stride(); j++)
+      EXPECT_EQ(0.0, a.data()[i * a.stride() + j]);
+}
+
+TEST(TDynamicMatrix, row_view_writes_to_matrix)
+{
+  TDynamicMatrix<int> m(3);
+  TDynamicVector<int> v(3);
+  v[0] = 1; v[1] = 2; v[2] = 3;
+
+  m[1] = v;
+
+  EXPECT_EQ(2, m[1][1]);
+  EXPECT_EQ(v, TDynamicVector<int>(m[1]));
+}
+
+TEST(TDynamicMatrix, throws_when_get_row_element_with_too_large_index)
+{
+  TDynamicMatrix<int> m(3);
+
+  ASSERT_ANY_THROW(m.at(3));
+  ASSERT_ANY_THROW(m[0].at(3));
+}
+
+TEST(TDynamicMatrix, can_multiply_matrices_with_equal_size)
+{
+  TDynamicMatrix<int> a(2), b(2), c(2);
+  a[0][0] = 1; a[0][1] = 2; a[1][0] = 3; a[1][1] = 4;
+  b[0][0] = 5; b[0][1] = 6; b[1][0] = 7; b[1][1] = 8;
+  c[0][0] = 19; c[0][1] = 22; c[1][0] = 43; c[1][1] = 50;
+
+  EXPECT_EQ(c, a * b);
+}
+
+TEST(TDynamicMatrix, can_multiply_matrix_by_vector)
+{
+  TDynamicMatrix<int> a(2);
+  TDynamicVector<int> v(2), res(2);
+  a[0][0] = 1; a[0][1] = 2; a[1][0] = 3; a[1][1] = 4;
+  v[0] = 1; v[1] = 1;
+  res[0] = 3; res[1] = 7;
+
+  EXPECT_EQ(res, a * v);
+}
+
+TEST(TDynamicMatrix, blocked_product_matches_naive_one)
+{
+  const size_t n = 301;
+  TDynamicMatrix<int> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = int((i + 2 * j) % 7) - 3;
+      b[i][j] = int((3 * i + j) % 5) - 2;
+    }
+  for (size_t i = 0; i < n; i++)
+    for (size_t k = 0; k < n; k++)
+      for (size_t j = 0; j < n; j++)
+        c[i][j] += a[i][k] * b[k][j];
+
+  EXPECT_EQ(c, a * b);
+}
+
+TEST(TDynamicMatrix, packed_product_matches_naive_one)
+{
+  const size_t n = 263;
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = double((i + 2 * j) % 7) - 3;
+      b[i][j] = double((3 * i + j) % 5) - 2;
+    }
+  for (size_t i = 0; i < n; i++)
+    for (size_t k = 0; k < n; k++)
+      for (size_t j = 0; j < n; j++)
+        c[i][j] += a[i][k] * b[k][j];
+
+  EXPECT_EQ(c, a * b);
+}
+
+TEST(TDynamicMatrix, portable_micro_kernel_accumulates_block)
+{
+  const size_t MR = TGemmPacked<float>::MR, NR = TGemmPacked<float>::NR, kc = 3;
+  float a[MR * kc], b[kc * NR], ap[MR * kc], bp[kc * NR], c[MR * NR], expected[MR * NR];
+  for (size_t i = 0; i < MR * kc; i++)
+    a[i] = float(i % 5);
+  for (size_t i = 0; i < kc * NR; i++)
+    b[i] = float(i % 3);
+  for (size_t r = 0; r < MR; r++)
+    for (size_t j = 0; j < NR; j++)
+    {
+      c[r * NR + j] = 1.0f;
+      expected[r * NR + j] = 1.0f;
+      for (size_t p = 0; p < kc; p++)
+        expected[r * NR + j] += a[r * kc + p] * b[p * NR + j];
+    }
+  gemm_pack_a_panels(MR, kc, a, kc, ap);
+  gemm_pack_b_panels(kc, NR, b, NR, bp);
+
+  gemm_ukernel_portable(kc, ap, bp, c, NR);
+
+  for (size_t i = 0; i < MR * NR; i++)
+    EXPECT_EQ(expected[i], c[i]);
+}
+
+TEST(TDynamicMatrix, can_evaluate_fused_expression)
+{
+  TDynamicMatrix<int> a(3), b(3), c(3);
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+    {
+      a[i][j] = int(i + j);
+      b[i][j] = int(i * j);
+      c[i][j] = 1;
+    }
+
+  TDynamicMatrix<int> r = a + b * 2 - c;
+
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+      EXPECT_EQ(int(i + j + 2 * i * j) - 1, r[i][j]);
+}
+
+TEST(TDynamicMatrix, can_multiply_matrix_expressions)
+{
+  TDynamicMatrix<int> a(2), b(2);
+  a[0][0] = 1; a[0][1] = 2; a[1][0] = 3; a[1][1] = 4;
+  b[0][0] = 1; b[1][1] = 1;
+  TDynamicVector<int> v(2);
+  v[0] = 1; v[1] = 2;
+
+  TDynamicMatrix<int> sum = a + b;
+
+  EXPECT_EQ(sum * sum, (a + b) * (a + b));
+  EXPECT_EQ(sum * (v * 2), (a + b) * (v + v));
+}
+
+TEST(TDynamicMatrix, product_with_temporary_is_computed_at_once)
+{
+  TDynamicMatrix<int> a(3), b(3);
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+    {
+      a[i][j] = int(i + 2 * j);
+      b[i][j] = int(3 * i + j);
+    }
+  auto make = [&]() { return TDynamicMatrix<int>(a); };
+
+  auto c = make() * b;
+  auto d = a * make();
+  auto e = make() * make();
+  TDynamicMatrix<int> p = a * b;
+
+  EXPECT_TRUE((std::is_same<TDynamicMatrix<int>, decltype(c)>::value));
+  EXPECT_TRUE((std::is_same<TDynamicMatrix<int>, decltype(d)>::value));
+  EXPECT_TRUE((std::is_same<TDynamicMatrix<int>, decltype(e)>::value));
+  EXPECT_EQ(p, c);
+  EXPECT_EQ(a * a, d);
+  EXPECT_EQ(a * a, e);
+}
+
+TEST(TDynamicMatrix, can_accumulate_product_in_place)
+{
+  const size_t n = 37;
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = double(i + j);
+      b[i][j] = double(i) - double(j);
+      c[i][j] = 1.0;
+    }
+  TDynamicMatrix<double> expected = c + a * b;
+
+  c += a * b;
+
+  EXPECT_EQ(expected, c);
+}
+
+TEST(TDynamicMatrix, can_assign_product_that_uses_destination)
+{
+  TDynamicMatrix<int> a(2), b(2);
+  a[0][0] = 1; a[0][1] = 2; a[1][0] = 3; a[1][1] = 4;
+  b[0][0] = 0; b[0][1] = 1; b[1][0] = 1; b[1][1] = 0;
+  TDynamicMatrix<int> expected = a * b;
+
+  a = a * b;
+  b += b * b;
+  b -= expected;
+  b *= 2;
+
+  EXPECT_EQ(expected, a);
+  EXPECT_EQ(-2, b[0][0]);
+  EXPECT_EQ(-6, b[1][0]);
+}
+
+TEST(TDynamicMatrix, operation_on_temporary_reuses_its_memory)
+{
+  // размер больше встроенного буфера: память временной матрицы в куче
+  TDynamicMatrix<int> a(5), b(5);
+  a[0][0] = 1; a[0][1] = 2; a[1][0] = 3; a[1][1] = 4;
+  for (size_t i = 0; i < 5; i++)
+    b[i][i] = 1;
+  TDynamicMatrix<int> c(a);
+  const int* p = c.data();
+
+  TDynamicMatrix<int> r = std::move(c) + a * b;
+  TDynamicMatrix<int> s = b - TDynamicMatrix<int>(a) * 2;
+
+  EXPECT_EQ(p, r.data());
+  EXPECT_EQ(8, r[1][1]);
+  EXPECT_EQ(-4, s[0][1]);
+  EXPECT_EQ(-7, s[1][1]);
+}
+
+TEST(TDynamicMatrix, gemm_and_gemv_apply_alpha_and_beta)
+{
+  const size_t n = 45;
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  TDynamicVector<double> x(n), y(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    x[i] = double(i % 3);
+    y[i] = 1.0;
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = double((i + 2 * j) % 5);
+      b[i][j] = double((3 * i + j) % 4) - 1.0;
+      c[i][j] = 1.0;
+    }
+  }
+  TDynamicMatrix<double> ab = a * b;
+  TDynamicVector<double> ax = a * x;
+
+  gemm(2.0, a, b, -1.0, c);
+  gemv(3.0, a, x, 2.0, y);
+  gemm(1.0, a, b, 0.0, a);
+
+  for (size_t i = 0; i < n; i++)
+  {
+    EXPECT_EQ(3.0 * ax[i] + 2.0, y[i]);
+    for (size_t j = 0; j < n; j++)
+      EXPECT_EQ(2.0 * ab[i][j] - 1.0, c[i][j]);
+  }
+  EXPECT_EQ(ab, a);
+}
+
+TEST(TDynamicMatrix, stores_all_rows_in_one_block_of_given_allocator)
+{
+  size_t blocks = 0;
+  TCountingAllocator<double> a(&blocks);
+  {
+    TDynamicMatrix<double, TCountingAllocator<double>> m(10, a), c(m);
+    m[9][9] = 1.0;
+    EXPECT_EQ(2u, blocks);
+
+    c = m * 2.0 + c;
+    c += m;
+    EXPECT_EQ(2u, blocks);
+    EXPECT_EQ(3.0, c[9][9]);
+  }
+  EXPECT_EQ(0u, blocks);
+}
+
+TEST(TDynamicMatrix, expression_result_is_fully_written)
+{
+  const size_t n = 40;
+  TDynamicMatrix<double> a(n, UNINITIALIZED);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double(i * n + j);
+  TDynamicVector<double> x(n);
+  x[0] = 1.0;
+
+  TDynamicMatrix<double> b = a * 2.0 - a;
+  TDynamicMatrix<double> c = b * a;
+  TDynamicVector<double> y = a * x;
+
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(c, a * a);
+  for (size_t i = 0; i < n; i++)
+    EXPECT_EQ(double(i * n), y[i]);
+}
+
+TEST(TDynamicMatrix, can_create_rectangular_matrix)
+{
+  TDynamicMatrix<int> m(3, 70);
+
+  EXPECT_EQ(3u, m.rows());
+  EXPECT_EQ(70u, m.cols());
+  EXPECT_LE(70u, m.stride());
+  EXPECT_EQ(0, m[2][69]);
+  ASSERT_ANY_THROW(m.at(3));
+  ASSERT_ANY_THROW(m[2].at(70));
+}
+
+TEST(TDynamicMatrix, size_limit_applies_to_element_count)
+{
+  ASSERT_NO_THROW(TDynamicMatrix<char> m(MAX_MATRIX_SIZE * 100, 2));
+  ASSERT_ANY_THROW(TDynamicMatrix<char> m(MAX_MATRIX_SIZE * 100, MAX_MATRIX_SIZE / 50));
+  ASSERT_ANY_THROW(TDynamicMatrix<int> m(5, 0));
+}
+
+TEST(TDynamicMatrix, padding_does_not_refuse_matrices_at_element_limit)
+{
+  const size_t n = 100, m = MAX_MATRIX_ELEMENTS / n;
+  TDynamicMatrix<char> a(m, n), b(MAX_MATRIX_ELEMENTS, 1);
+
+  EXPECT_NE(0u, n % TDynamicMatrix<char>::ROW_ALIGN);
+  EXPECT_EQ(n, a.stride());
+  EXPECT_EQ(1u, b.stride());
+  a[m - 1][n - 1] = 'x';
+  EXPECT_EQ('x', a.data()[m * n - 1]);
+  ASSERT_ANY_THROW(TDynamicMatrix<char> c(m + 1, n));
+}
+
+TEST(TDynamicMatrix, matrices_with_different_shape_are_not_equal)
+{
+  TDynamicMatrix<int> a(2, 6), b(3, 4), c(6, 2);
+
+  EXPECT_NE(a, b);
+  EXPECT_NE(a, c);
+  ASSERT_ANY_THROW(a + c);
+  ASSERT_ANY_THROW(a * a);
+}
+
+TEST(TDynamicMatrix, assignment_takes_shape_of_source)
+{
+  TDynamicMatrix<int> a(2, 5), b(4);
+  a[1][4] = 3;
+
+  b = a;
+  EXPECT_EQ(2u, b.rows());
+  EXPECT_EQ(5u, b.cols());
+  EXPECT_EQ(a, b);
+
+  b = a + a;
+  EXPECT_EQ(6, b[1][4]);
+}
+
+TEST(TDynamicMatrix, can_multiply_rectangular_matrix_by_vector)
+{
+  TDynamicMatrix<double> m(2, 3);
+  m[0][0] = 1; m[0][1] = 2; m[0][2] = 3;
+  m[1][0] = 4; m[1][1] = 5; m[1][2] = 6;
+  TDynamicVector<double> v(3);
+  v[0] = 1; v[1] = 0; v[2] = -1;
+
+  TDynamicVector<double> r = m * v;
+
+  ASSERT_EQ(2u, r.size());
+  EXPECT_EQ(-2.0, r[0]);
+  EXPECT_EQ(-2.0, r[1]);
+  ASSERT_ANY_THROW(m * TDynamicVector<double>(2));
+}
+
+// Произведение (m x k) * (k x n) для всех ядер: узкий и низкий результат,
+// панели при малой внутренней размерности и общий случай
+template<typename T>
+void check_rectangular_product(size_t m, size_t k, size_t n)
+{
+  TDynamicMatrix<T> a(m, k), b(k, n), c(m, n);
+  for (size_t i = 0; i < m; i++)
+    for (size_t p = 0; p < k; p++)
+      a[i][p] = T(int((i + 2 * p) % 7) - 3);
+  for (size_t p = 0; p < k; p++)
+    for (size_t j = 0; j < n; j++)
+      b[p][j] = T(int((3 * p + j) % 5) - 2);
+  for (size_t i = 0; i < m; i++)
+    for (size_t p = 0; p < k; p++)
+      for (size_t j = 0; j < n; j++)
+        c[i][j] += a[i][p] * b[p][j];
+
+  TDynamicMatrix<T> r = a * b;
+  ASSERT_EQ(m, r.rows());
+  ASSERT_EQ(n, r.cols());
+  EXPECT_EQ(c, r);
+
+  r += a * b;
+  gemm(T(-1), a, b, T(1), r);
+  EXPECT_EQ(c, r);
+}
+
+TEST(TDynamicMatrix, rectangular_products_match_naive_ones)
+{
+  check_rectangular_product<double>(3000, 7, 3);
+  check_rectangular_product<double>(2, 300, 1000);
+  check_rectangular_product<double>(5000, 16, 40);
+  check_rectangular_product<double>(20, 9, 7000);
+  check_rectangular_product<float>(37, 300, 45);
+  check_rectangular_product<int>(1000, 5, 30);
+  check_rectangular_product<int>(3, 50, 200);
+}
+
+TEST(TDynamicMatrix, rectangular_matrix_io_keeps_shape)
+{
+  TDynamicMatrix<int> a(2, 3), b(2, 3);
+  for (size_t i = 0; i < 2; i++)
+    for (size_t j = 0; j < 3; j++)
+      a[i][j] = int(i * 3 + j);
+  std::stringstream s;
+
+  s << a;
+  s >> b;
+
+  EXPECT_EQ(a, b);
+}
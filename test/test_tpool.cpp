@@ -0,0 +1,87 @@
+#include "tpool.h"
+
+#include <gtest.h>
+#include <thread>
+#include <memory>
+
+// Статический объект создан до общего пула, а буфер возвращает в пул
+// при выходе из программы, после разрушения локальных статических объектов
+static std::unique_ptr<TPoolMatrix<double>> exit_matrix;
+
+TEST(TBufferPool, reuses_buffer_of_destroyed_matrix)
+{
+  TBufferPool pool;
+  TPoolAllocator<double> a(pool);
+  const double* p;
+  {
+    TPoolMatrix<double> m(50, a);
+    p = m.data();
+  }
+  TPoolMatrix<double> m(50, a);
+
+  EXPECT_EQ(p, m.data());
+  EXPECT_EQ(1u, pool.stats().hits);
+  EXPECT_EQ(1u, pool.stats().misses);
+  EXPECT_EQ(0.5, pool.stats().hit_rate());
+}
+
+TEST(TBufferPool, rounds_request_to_size_class)
+{
+  TBufferPool pool;
+  void* p = pool.acquire(1000);
+  pool.release(p, 1000);
+
+  EXPECT_EQ(1024u, pool.stats().bytes_held);
+  EXPECT_EQ(p, pool.acquire(900));
+  void* q = pool.acquire(1000);
+  EXPECT_NE(p, q);
+  pool.release(p, 900);
+  pool.release(q, 1000);
+}
+
+TEST(TBufferPool, respects_limits)
+{
+  TBufferPool pool(4096, 2048);
+  TPoolAllocator<char> a(pool);
+  {
+    TPoolVector<char> big(4000, a), v1(2000, a), v2(2000, a), v3(2000, a);
+  }
+
+  TPoolStats s = pool.stats();
+  EXPECT_EQ(2u, s.returns);
+  EXPECT_EQ(2u, s.drops);
+  EXPECT_EQ(4096u, s.bytes_held);
+
+  pool.trim();
+  EXPECT_EQ(0u, pool.stats().bytes_held);
+}
+
+TEST(TBufferPool, can_be_used_from_several_threads)
+{
+  TBufferPool pool;
+  auto work = [&pool]() {
+    TPoolAllocator<double> a(pool);
+    for (int i = 0; i < 1000; i++)
+    {
+      TPoolVector<double> v(100 + i % 3, a);
+      v[99] = 1.0;
+    }
+  };
+  std::thread t1(work), t2(work);
+  t1.join();
+  t2.join();
+
+  TPoolStats s = pool.stats();
+  EXPECT_EQ(2000u, s.hits + s.misses);
+  EXPECT_EQ(2000u, s.returns);
+  EXPECT_LE(s.misses, 6u);
+}
+
+TEST(TBufferPool, shared_pool_outlives_static_matrices)
+{
+  exit_matrix.reset(new TPoolMatrix<double>(40));
+  TBufferPool& pool = TBufferPool::instance();
+
+  EXPECT_EQ(&pool, exit_matrix->get_allocator().pool());
+  EXPECT_EQ(&pool, &TBufferPool::instance());
+}
@@ -0,0 +1,95 @@
+#include "tstaticmatrix.h"
+
+#include <gtest.h>
+#include <type_traits>
+
+// сложение векторов разного размера не должно компилироваться
+template<typename A, typename B, typename = void>
+struct can_add : std::false_type {};
+template<typename A, typename B>
+struct can_add<A, B, decltype(void(std::declval<A>() + std::declval<B>()))> : std::true_type {};
+
+TEST(TStaticVector, has_no_heap_storage)
+{
+  EXPECT_EQ(3 * sizeof(double), sizeof(TStaticVector<double, 3>));
+  EXPECT_EQ(16 * sizeof(float), sizeof(TStaticMatrix<float, 4>));
+}
+
+TEST(TStaticVector, can_be_evaluated_at_compile_time)
+{
+  constexpr TStaticVector<int, 3> a(1, 2, 3), b(4, 5, 6);
+  constexpr TStaticVector<int, 3> c = a + b * 2;
+  static_assert(c[2] == 15, "static vector expression");
+  static_assert(a * b == 32, "static dot product");
+
+  EXPECT_EQ((TStaticVector<int, 3>(9, 12, 15)), c);
+}
+
+TEST(TStaticVector, rejects_operands_of_different_size)
+{
+  static_assert(can_add<TStaticVector<int, 3>, TStaticVector<int, 3>>::value, "same size");
+  static_assert(!can_add<TStaticVector<int, 3>, TStaticVector<int, 4>>::value, "different size");
+  static_assert(!can_add<TStaticMatrix<int, 3>, TStaticMatrix<int, 2>>::value, "different size");
+}
+
+TEST(TStaticVector, throws_when_index_is_out_of_range)
+{
+  TStaticVector<int, 3> v;
+
+  ASSERT_ANY_THROW(v.at(3));
+}
+
+TEST(TStaticVector, can_use_compound_assignment)
+{
+  TStaticVector<double, 10> a(1.0, 2.0), b(1.0, 1.0, 1.0);
+
+  a += b;
+  a *= 2.0;
+  a -= 1.0;
+
+  EXPECT_EQ(3.0, a[0]);
+  EXPECT_EQ(5.0, a[1]);
+  EXPECT_EQ(1.0, a[2]);
+  EXPECT_EQ(-1.0, a[9]);
+}
+
+TEST(TStaticMatrix, can_multiply_at_compile_time)
+{
+  constexpr TStaticMatrix<int, 4> e = TStaticMatrix<int, 4>::identity();
+  constexpr TStaticMatrix<int, 4> m = e * 3 + e;
+  constexpr TStaticVector<int, 4> v = (m * e) * TStaticVector<int, 4>(1, 2, 3, 4);
+  static_assert(m(1, 1) == 4 && m(1, 2) == 0, "static matrix expression");
+  static_assert(v.get<3>() == 16, "static matrix-vector product");
+
+  EXPECT_EQ(m, m * e);
+}
+
+template<size_t N>
+void check_static_product_matches_naive()
+{
+  TStaticMatrix<long, N> a, b;
+  for (size_t i = 0; i < N; i++)
+    for (size_t j = 0; j < N; j++)
+    {
+      a[i][j] = long(i + 2 * j) - 3;
+      b[i][j] = long(3 * i + j) % 5;
+    }
+
+  TStaticMatrix<long, N> c = a * b;
+
+  for (size_t i = 0; i < N; i++)
+    for (size_t j = 0; j < N; j++)
+    {
+      long s = 0;
+      for (size_t k = 0; k < N; k++)
+        s += a[i][k] * b[k][j];
+      EXPECT_EQ(s, c[i][j]);
+    }
+}
+
+TEST(TStaticMatrix, product_matches_naive_for_unrolled_and_looped_sizes)
+{
+  check_static_product_matches_naive<3>();
+  check_static_product_matches_naive<8>();
+  check_static_product_matches_naive<9>();
+}
@@ -0,0 +1,153 @@
+#include "tutmatrix.h"
+
+#include <gtest.h>
+
+TEST(TUpperTriangularMatrix, can_create_matrix_with_positive_length)
+{
+  ASSERT_NO_THROW(TUpperTriangularMatrix<int> m(5));
+}
+
+TEST(TUpperTriangularMatrix, cant_create_too_large_matrix)
+{
+  ASSERT_ANY_THROW(TUpperTriangularMatrix<int> m(MAX_MATRIX_SIZE + 1));
+}
+
+TEST(TUpperTriangularMatrix, stores_only_upper_triangle)
+{
+  TUpperTriangularMatrix<int> m(4);
+
+  EXPECT_EQ(10u, m.packed_size());
+}
+
+TEST(TUpperTriangularMatrix, can_set_and_get_element)
+{
+  TUpperTriangularMatrix<int> m(4);
+  m[1][3] = 7;
+
+  EXPECT_EQ(7, m.at(1, 3));
+  EXPECT_EQ(0, m.get(3, 1));
+}
+
+TEST(TUpperTriangularMatrix, throws_when_access_element_below_diagonal)
+{
+  TUpperTriangularMatrix<int> m(4);
+
+  ASSERT_ANY_THROW(m.at(2, 1));
+}
+
+TEST(TUpperTriangularMatrix, row_reads_zero_below_diagonal_and_keeps_previous_row)
+{
+  TUpperTriangularMatrix<int> u(4);
+  u[1][3] = 5;
+  TDynamicVector<int> v(4), w(4);
+  v[2] = 6; v[3] = 8;
+  w[1] = 1;
+
+  EXPECT_EQ(0, u[2][1]);
+  ASSERT_ANY_THROW(u[2][1] = 99);
+  ASSERT_ANY_THROW(u[2] = w);
+  u[2] = v;
+
+  EXPECT_EQ(5, u.at(1, 3));
+  EXPECT_EQ(6, u.at(2, 2));
+  EXPECT_EQ(8, u[2][3]);
+  ASSERT_ANY_THROW(u[2].at(4));
+}
+
+TEST(TUpperTriangularMatrix, can_add_and_subtract_matrices_with_equal_size)
+{
+  TUpperTriangularMatrix<int> a(3), b(3);
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = i; j < 3; j++)
+    {
+      a[i][j] = int(i * 10 + j);
+      b[i][j] = 1;
+    }
+
+  TUpperTriangularMatrix<int> c = a + b;
+
+  EXPECT_EQ(13, c[1][2]);
+  EXPECT_EQ(a, c - b);
+}
+
+TEST(TUpperTriangularMatrix, cant_add_matrices_with_not_equal_size)
+{
+  TUpperTriangularMatrix<int> a(3), b(4);
+
+  ASSERT_ANY_THROW(a + b);
+}
+
+TEST(TUpperTriangularMatrix, matrix_vector_product_matches_dense_one)
+{
+  TUpperTriangularMatrix<int> a(4);
+  TDynamicVector<int> v(4);
+  for (size_t i = 0; i < 4; i++)
+  {
+    v[i] = int(i + 1);
+    for (size_t j = i; j < 4; j++)
+      a[i][j] = int(i + 2 * j);
+  }
+
+  EXPECT_EQ(a.dense() * v, a * v);
+  EXPECT_EQ(a.dense() * 3, (a * 3).dense());
+}
+
+TEST(TUpperTriangularMatrix, product_of_triangular_matrices_matches_dense_one)
+{
+  const size_t n = 5;
+  TUpperTriangularMatrix<int> a(n), b(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = i; j < n; j++)
+    {
+      a[i][j] = int(i + j + 1);
+      b[i][j] = int(2 * i - j + 3);
+    }
+
+  EXPECT_EQ(a.dense() * b.dense(), (a * b).dense());
+}
+
+TEST(TUpperTriangularMatrix, mixed_products_match_dense_ones)
+{
+  const size_t n = 4;
+  TUpperTriangularMatrix<int> u(n);
+  TDynamicMatrix<int> m(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      m[i][j] = int(3 * i + j);
+      if (j >= i)
+        u[i][j] = int(i * j + 1);
+    }
+
+  EXPECT_EQ(u.dense() * m, u * m);
+  EXPECT_EQ(m * u.dense(), m * u);
+}
+
+TEST(TUpperTriangularMatrix, cant_multiply_matrices_with_not_equal_size)
+{
+  TUpperTriangularMatrix<int> a(3), b(4);
+  TDynamicMatrix<int> m(4);
+
+  ASSERT_ANY_THROW(a * b);
+  ASSERT_ANY_THROW(a * m);
+}
+
+TEST(TUpperTriangularMatrix, products_with_rectangular_matrices_match_dense_ones)
+{
+  const size_t n = 4;
+  TUpperTriangularMatrix<int> u(n);
+  TDynamicMatrix<int> r(n, 7), l(3, n);
+  for (size_t i = 0; i < n; i++)
+  {
+    for (size_t j = i; j < n; j++)
+      u[i][j] = int(i + 2 * j + 1);
+    for (size_t j = 0; j < 7; j++)
+      r[i][j] = int(i * 7 + j) % 5;
+    for (size_t j = 0; j < 3; j++)
+      l[j][i] = int(j + i) % 3;
+  }
+
+  EXPECT_EQ(u.dense() * r, u * r);
+  EXPECT_EQ(l * u.dense(), l * u);
+  ASSERT_ANY_THROW(u * l);
+}
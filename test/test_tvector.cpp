@@ -1,6 +1,8 @@
 #include "tmatrix.h"
 
 #include <gtest.h>
+#include "test_allocator.h"
+#include <string>
 
 TEST(TDynamicVector, can_create_vector_with_positive_length)
 {
@@ -38,7 +40,7 @@ TEST(TDynamicVector, can_get_size)
 {
   TDynamicVector<int> v(4);
 
-  EXPECT_EQ(4, v.size());
+  EXPECT_EQ(4u, v.size());
 }
 
 //TEST(TDynamicVector, can_set_and_get_element)
@@ -139,3 +141,259 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
   ADD_FAILURE();
 }
 
+
+template<typename T>
+void check_simd_kernels_match_portable()
+{
+  const size_t n = 37;
+  T a[n], b[n], c[n], expected[n];
+  for (size_t i = 0; i < n; i++)
+  {
+    a[i] = T(i % 11) - T(5);
+    b[i] = T(3 * i % 7) + T(1);
+  }
+  const TVecKernels<T>& p = *vec_kernels_for<T>(SIMD_PORTABLE);
+  for (int level = SIMD_SSE2; level <= SIMD_AVX512; level++)
+  {
+    const TVecKernels<T>* k = vec_kernels_for<T>(TSimdLevel(level));
+    if (k == nullptr)
+      continue;
+    p.add(a, b, expected, n); k->add(a, b, c, n);
+    EXPECT_TRUE(std::equal(c, c + n, expected));
+    p.sub(a, b, expected, n); k->sub(a, b, c, n);
+    EXPECT_TRUE(std::equal(c, c + n, expected));
+    p.add_scalar(a, T(3), expected, n); k->add_scalar(a, T(3), c, n);
+    EXPECT_TRUE(std::equal(c, c + n, expected));
+    p.sub_scalar(a, T(3), expected, n); k->sub_scalar(a, T(3), c, n);
+    EXPECT_TRUE(std::equal(c, c + n, expected));
+    p.mul_scalar(a, T(-3), expected, n); k->mul_scalar(a, T(-3), c, n);
+    EXPECT_TRUE(std::equal(c, c + n, expected));
+    std::copy(b, b + n, expected); std::copy(b, b + n, c);
+    p.axpy(T(-3), a, expected, n); k->axpy(T(-3), a, c, n);
+    EXPECT_TRUE(std::equal(c, c + n, expected));
+    EXPECT_EQ(p.dot(a, b, n), k->dot(a, b, n));
+    EXPECT_EQ(p.dot_compensated(a, b, n), k->dot_compensated(a, b, n));
+  }
+}
+
+TEST(TDynamicVector, simd_kernels_match_portable_ones)
+{
+  check_simd_kernels_match_portable<float>();
+  check_simd_kernels_match_portable<double>();
+  check_simd_kernels_match_portable<int32_t>();
+  check_simd_kernels_match_portable<int64_t>();
+}
+
+TEST(TDynamicVector, large_int64_products_are_exact)
+{
+  TDynamicVector<int64_t> v(9);
+  for (size_t i = 0; i < v.size(); i++)
+    v[i] = int64_t(3000000000LL) + int64_t(i);
+
+  TDynamicVector<int64_t> res = v * int64_t(-7);
+
+  for (size_t i = 0; i < v.size(); i++)
+    EXPECT_EQ(v[i] * -7, res[i]);
+}
+
+TEST(TDynamicVector, compensated_dot_keeps_small_terms)
+{
+  TDynamicVector<double> a(1000), b(1000);
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    a[i] = i % 4 == 0 ? 1e16 : i % 4 == 2 ? -1e16 : 1.0;
+    b[i] = 1.0;
+  }
+
+  EXPECT_EQ(500.0, dot(a, b, DOT_COMPENSATED));
+}
+
+TEST(TDynamicVector, fast_dot_of_long_float_vectors_is_accurate)
+{
+  const size_t n = 1000000;
+  TDynamicVector<float> a(n), b(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    a[i] = 0.1f;
+    b[i] = 1.0f;
+  }
+  const double exact = double(0.1f) * n;
+
+  EXPECT_NEAR(exact, a * b, exact * 1e-6);
+  EXPECT_NEAR(exact, dot(a, b, DOT_COMPENSATED), exact * 1e-7);
+}
+
+TEST(TDynamicVector, arithmetic_operators_return_lazy_expressions)
+{
+  TDynamicVector<int> a(3), b(3);
+
+  EXPECT_FALSE((std::is_same<TDynamicVector<int>, decltype(a + b * 2)>::value));
+  EXPECT_TRUE(TIsVecExpr<decltype(a + b * 2)>::value);
+}
+
+TEST(TDynamicVector, can_evaluate_fused_expression)
+{
+  TDynamicVector<int> a(5), b(5), c(5);
+  for (size_t i = 0; i < 5; i++)
+  {
+    a[i] = int(i);
+    b[i] = int(2 * i);
+    c[i] = 1;
+  }
+
+  TDynamicVector<int> r = a + b * 2 - c + 3;
+
+  for (size_t i = 0; i < 5; i++)
+    EXPECT_EQ(int(5 * i + 2), r[i]);
+}
+
+TEST(TDynamicVector, can_assign_expression_that_uses_itself)
+{
+  TDynamicVector<int> a(4), b(4);
+  for (size_t i = 0; i < 4; i++)
+  {
+    a[i] = int(i);
+    b[i] = 10;
+  }
+
+  a = a + b * 2;
+
+  EXPECT_EQ(23, a[3]);
+}
+
+TEST(TDynamicVector, cant_build_expression_from_vectors_with_not_equal_size)
+{
+  TDynamicVector<int> a(4), b(5);
+
+  ASSERT_ANY_THROW(a * 2 + b);
+}
+
+TEST(TDynamicVector, can_use_compound_assignment)
+{
+  TDynamicVector<int> a(4), b(4);
+  for (size_t i = 0; i < 4; i++)
+  {
+    a[i] = int(i);
+    b[i] = 1;
+  }
+
+  a += b * 3;
+  a -= b;
+  a *= 2;
+  a += 1;
+
+  for (size_t i = 0; i < 4; i++)
+    EXPECT_EQ(int(2 * (i + 2) + 1), a[i]);
+}
+
+TEST(TDynamicVector, operation_on_temporary_reuses_its_memory)
+{
+  // размер больше встроенного буфера: память временного вектора в куче
+  const size_t n = 100;
+  TDynamicVector<int> a(n), b(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    a[i] = int(i);
+    b[i] = 10;
+  }
+  TDynamicVector<int> c(a);
+  const int* p = c.data();
+
+  TDynamicVector<int> r = std::move(c) * 2 + b;
+  TDynamicVector<int> s = b - TDynamicVector<int>(a);
+
+  EXPECT_EQ(p, r.data());
+  EXPECT_EQ(14, r[2]);
+  EXPECT_EQ(8, s[2]);
+}
+
+TEST(TDynamicVector, can_scale_and_accumulate_in_place)
+{
+  TDynamicVector<double> x(5), y(5), z(4);
+  for (size_t i = 0; i < 5; i++)
+  {
+    x[i] = double(i);
+    y[i] = 1.0;
+  }
+
+  axpy(2.0, x, y);
+  scal(0.5, y);
+
+  for (size_t i = 0; i < 5; i++)
+    EXPECT_EQ(double(i) + 0.5, y[i]);
+  ASSERT_ANY_THROW(axpy(1.0, x, z));
+}
+
+TEST(TDynamicVector, short_vector_is_stored_inline)
+{
+  TDynamicVector<double> v(4);
+
+  EXPECT_TRUE(v.data() >= reinterpret_cast<const double*>(&v) &&
+    v.data() < reinterpret_cast<const double*>(&v + 1));
+}
+
+TEST(TDynamicVector, move_and_swap_keep_values_of_inline_and_heap_vectors)
+{
+  TDynamicVector<int> s1(3), s2(5), h1(100), h2(200);
+  for (size_t i = 0; i < 3; i++)
+    s1[i] = int(i);
+  for (size_t i = 0; i < 5; i++)
+    s2[i] = int(10 + i);
+  for (size_t i = 0; i < 100; i++)
+    h1[i] = int(100 + i);
+  h2[199] = 7;
+  TDynamicVector<int> s1c(s1), s2c(s2), h1c(h1), h2c(h2);
+
+  swap(s1, s2);
+  EXPECT_EQ(s2c, s1);
+  EXPECT_EQ(s1c, s2);
+  swap(s1, h1);
+  EXPECT_EQ(h1c, s1);
+  EXPECT_EQ(s2c, h1);
+  swap(h2, s2);
+  EXPECT_EQ(s1c, h2);
+  EXPECT_EQ(h2c, s2);
+
+  TDynamicVector<int> m(std::move(h2));
+  EXPECT_EQ(s1c, m);
+  EXPECT_EQ(0u, h2.size());
+  m = std::move(s1);
+  EXPECT_EQ(h1c, m);
+}
+
+TEST(TDynamicVector, allocates_through_given_allocator)
+{
+  size_t blocks = 0;
+  TCountingAllocator<double> a(&blocks);
+  {
+    TDynamicVector<double, TCountingAllocator<double>> v(100, a), w(v), s(2, a);
+    EXPECT_EQ(2u, blocks);
+    EXPECT_EQ(a, w.get_allocator());
+
+    v = std::move(w);
+    swap(v, s);
+    EXPECT_EQ(1u, blocks);
+    EXPECT_EQ(100u, s.size());
+    EXPECT_EQ(2u, v.size());
+  }
+  EXPECT_EQ(0u, blocks);
+}
+
+TEST(TDynamicVector, can_create_uninitialized_vector)
+{
+  TDynamicVector<double> v(1000, UNINITIALIZED);
+  TDynamicVector<std::string> s(3, UNINITIALIZED);
+
+  EXPECT_EQ(1000u, v.size());
+  EXPECT_TRUE(s[2].empty());
+  ASSERT_ANY_THROW(TDynamicVector<int> w(0, UNINITIALIZED));
+}
+
+TEST(TDynamicVector, heap_storage_is_aligned)
+{
+  TDynamicVector<double> v(100);
+  TDynamicVector<char> c(1000);
+
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(v.data()) % TMATRIX_ALIGNMENT);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(c.data()) % TMATRIX_ALIGNMENT);
+}
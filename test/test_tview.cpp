@@ -0,0 +1,278 @@
+#include "tview.h"
+
+#include <gtest.h>
+
+TEST(TVectorView, wraps_external_array_without_copying)
+{
+  double a[5] = { 1, 2, 3, 4, 5 };
+  TVectorView<double> v(a, 5);
+
+  v[2] = 10.0;
+
+  EXPECT_EQ(10.0, a[2]);
+  EXPECT_EQ(a, v.data());
+  ASSERT_ANY_THROW(v.at(5));
+}
+
+TEST(TVectorView, strided_view_takes_every_step_element)
+{
+  int a[9] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+  TVectorView<int> v(a, 3, 4);
+
+  EXPECT_EQ(4, v[1]);
+  EXPECT_EQ(8, v[2]);
+}
+
+TEST(TVectorView, can_be_mixed_with_vectors_in_expressions)
+{
+  double a[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  TVectorView<const double> even(a, 4, 2), first(a, 4);
+  TDynamicVector<double> x(4);
+  x[0] = 1; x[1] = 1; x[2] = 1; x[3] = 1;
+
+  TDynamicVector<double> r = even + x * 2.0 - first;
+
+  EXPECT_EQ(2.0, r[0]);
+  EXPECT_EQ(3.0, r[1]);
+  EXPECT_EQ(4.0, r[2]);
+  EXPECT_EQ(5.0, r[3]);
+  EXPECT_EQ(1.0 + 3 + 5 + 7, even * x);
+  EXPECT_EQ(even * x, dot(x, even, DOT_COMPENSATED));
+}
+
+TEST(TVectorView, assignment_writes_through_stride)
+{
+  double a[6] = {};
+  TVectorView<double> v(a, 3, 2);
+  TDynamicVector<double> x(3);
+  x[0] = 1; x[1] = 2; x[2] = 3;
+
+  v = x;
+  v += x;
+  v *= 0.5;
+  axpy(1.0, x, v);
+  scal(2.0, v);
+
+  EXPECT_EQ(4.0, a[0]);
+  EXPECT_EQ(0.0, a[1]);
+  EXPECT_EQ(12.0, a[4]);
+  EXPECT_EQ(x * 4.0, v);
+  EXPECT_NE(x, v);
+}
+
+TEST(TVectorView, cant_assign_vector_of_other_size)
+{
+  double a[4] = {};
+  TVectorView<double> v(a, 4);
+
+  ASSERT_ANY_THROW(v = TDynamicVector<double>(3));
+}
+
+TEST(TMatrixView, wraps_external_buffer_with_row_stride)
+{
+  int a[12] = { 1, 2, 0, 0, 3, 4, 0, 0, 9, 9, 9, 9 };
+  TMatrixView<int> m(a, 2, 4);
+
+  EXPECT_EQ(2u, m.rows());
+  EXPECT_EQ(2u, m.cols());
+  EXPECT_EQ(3, m[1][0]);
+  EXPECT_EQ(4, m(1, 1));
+}
+
+TEST(TMatrixView, can_be_mixed_with_matrices_in_expressions_and_products)
+{
+  const size_t n = 20;
+  TDynamicMatrix<double> a(n), b(n);
+  TDynamicVector<double> x(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    x[i] = double(i % 4);
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = double((i + 2 * j) % 5);
+      b[i][j] = double((3 * i + j) % 7);
+    }
+  }
+  std::vector<double> buf(n * 24);
+  TMatrixView<double> v(buf.data(), n, 24);
+
+  v = a;
+  TDynamicMatrix<double> s = v + b, p = v * b;
+
+  EXPECT_EQ(a, v);
+  EXPECT_EQ(a + b, s);
+  EXPECT_EQ(a * b, p);
+  EXPECT_EQ(a * x, v * x);
+}
+
+TEST(TMatrixView, kernels_write_into_view)
+{
+  const size_t n = 10;
+  TDynamicMatrix<double> a(n), b(n), c(n);
+  for (size_t i = 0; i < n; i++)
+  {
+    a[i][i] = 2.0;
+    b[i][(i + 1) % n] = 1.0;
+  }
+  TMatrixView<double> vc(c);
+  TVectorView<double> y(c[0].data(), n, c.stride());
+  TDynamicVector<double> x(n);
+  x[3] = 1.0;
+
+  gemm(1.0, a, b, 0.0, vc);
+  EXPECT_EQ(TDynamicMatrix<double>(a * b), c);
+
+  vc += a * b;
+  vc -= a;
+  vc *= 0.5;
+  EXPECT_EQ(2.0, c[2][3]);
+  EXPECT_EQ(-1.0, c[2][2]);
+
+  gemv(1.0, a, x, 0.0, y);
+  EXPECT_EQ(2.0, c[3][0]);
+}
+
+TEST(TMatrixView, gemv_and_dot_copy_strided_or_overlapping_operands)
+{
+  const size_t n = 6;
+  TDynamicMatrix<double> a(n), c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+    {
+      a[i][j] = double(i == j ? 2 : 0);
+      c[i][j] = double(i + j);
+    }
+  TDynamicVector<double> col(c.col(1)), y(n);
+
+  gemv(1.0, a, c.col(1), 0.0, y);
+  EXPECT_EQ(col * 2.0, y);
+  EXPECT_EQ(col * col, dot(c.col(1), col));
+  EXPECT_EQ(col * col, dot(col, c.col(1), DOT_COMPENSATED));
+  // x и y - одна и та же строка
+  gemv(1.0, a, c[2], 0.0, c[2]);
+  EXPECT_EQ(10.0, c[2][3]);
+}
+
+TEST(TMatrixView, block_refers_to_matrix_memory)
+{
+  TDynamicMatrix<int> a(6);
+  TMatrixView<int> b = a.block(1, 2, 2, 3);
+
+  b[1][2] = 7;
+  b = b + b;
+
+  EXPECT_EQ(2u, b.rows());
+  EXPECT_EQ(3u, b.cols());
+  EXPECT_EQ(14, a[2][4]);
+  EXPECT_EQ(a[2].data() + 2, b[1].data());
+  ASSERT_ANY_THROW(a.block(4, 0, 3, 1));
+  ASSERT_ANY_THROW(a.block(0, 0, 0, 1));
+}
+
+TEST(TMatrixView, assignment_of_overlapping_blocks)
+{
+  const size_t n = 5;
+  TDynamicMatrix<int> a(n), b(n), c(n), d(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = b[i][j] = c[i][j] = d[i][j] = int(10 * i + j);
+
+  a.block(1, 1, 3, 3) = a.block(0, 0, 3, 3);
+  b.block(0, 0, 3, 3) = b.block(1, 1, 3, 3) * 2;
+  c.block(1, 1, 3, 3) -= c.block(0, 0, 3, 3);
+  // диагональные отрезки d[i][i], d[i][i + 1] в строки d[i][1], d[i][2]
+  TMatrixView<int>(d.data() + 1, 3, 2, d.stride()) = TMatrixView<int>(d.data(), 3, 2, d.stride() + 1);
+
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+    {
+      ASSERT_EQ(int(10 * i + j), a[i + 1][j + 1]);
+      ASSERT_EQ(int(20 * (i + 1) + 2 * (j + 1)), b[i][j]);
+      ASSERT_EQ(11, c[i + 1][j + 1]);
+    }
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 2; j++)
+      ASSERT_EQ(int(11 * i + j), d[i][j + 1]);
+}
+
+TEST(TMatrixView, row_column_and_diagonal_views)
+{
+  const size_t n = 5;
+  TDynamicMatrix<double> a(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double(10 * i + j);
+
+  TVectorView<double> c = a.col(3), d = a.diag();
+  c *= 2.0;
+  d += 1.0;
+
+  EXPECT_EQ(46.0, a[2][3]);
+  EXPECT_EQ(33.0 * 2 + 1, a[3][3]);
+  EXPECT_EQ(23.0, a[2][2]);
+  EXPECT_EQ(a.row(1)[4], 14.0);
+  TVectorView<double> bc = a.block(1, 1, 3, 2).col(1);
+  EXPECT_EQ(a[1].data() + 2, bc.data());
+  EXPECT_EQ(3u, bc.size());
+  EXPECT_EQ(a.stride(), bc.inc());
+  ASSERT_ANY_THROW(a.col(n));
+}
+
+TEST(TMatrixView, rectangular_blocks_in_products_and_sums)
+{
+  const size_t n = 12;
+  TDynamicMatrix<double> a(n), c(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = double((i * 3 + j) % 7) - 3.0;
+  TMatrixView<const double> l = a.block(0, 0, 4, 6), r = a.block(6, 0, 6, 4);
+  TMatrixView<double> top = c.block(0, 0, 4, 4);
+
+  top = l * r;
+  c.block(4, 4, 4, 4) += l * r;
+  c.block(8, 0, 4, 6) = l + a.block(4, 6, 4, 6);
+
+  for (size_t i = 0; i < 4; i++)
+    for (size_t j = 0; j < 4; j++)
+    {
+      double s = 0.0;
+      for (size_t k = 0; k < 6; k++)
+        s += a[i][k] * a[6 + k][j];
+      EXPECT_EQ(s, c[i][j]);
+      EXPECT_EQ(s, c[4 + i][4 + j]);
+    }
+  EXPECT_EQ(a[1][2] + a[5][8], c[9][2]);
+  EXPECT_EQ(0.0, c[0][4]);
+  ASSERT_ANY_THROW(top = l * a.block(0, 0, 6, 5));
+
+  TDynamicMatrix<double> d = l + l;
+  EXPECT_EQ(4u, d.rows());
+  EXPECT_EQ(6u, d.cols());
+  EXPECT_EQ(2 * a[3][5], d[3][5]);
+}
+
+TEST(TMatrixView, blocked_transpose_of_matrices_and_blocks)
+{
+  const size_t n = 70;
+  TDynamicMatrix<int> a(n), b(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      a[i][j] = int(i * n + j);
+
+  transpose(a, b);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      ASSERT_EQ(a[j][i], b[i][j]);
+
+  transpose(b);
+  EXPECT_EQ(a, b);
+
+  transpose(a.block(0, 0, 40, 3), b.block(0, 0, 3, 40));
+  EXPECT_EQ(a[39][2], b[2][39]);
+  EXPECT_EQ(int(5 * n + 1), b[1][5]);
+
+  transpose(a, a);
+  EXPECT_EQ(int(n), a[0][1]);
+  ASSERT_ANY_THROW(transpose(a.block(0, 0, 2, 3), b.block(0, 0, 2, 3)));
+  ASSERT_ANY_THROW(transpose(a.block(0, 0, 2, 3)));
+}